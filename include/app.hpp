@@ -9,6 +9,11 @@
 #include <camera.hpp>
 #include <vecmath.hpp>
 #include <gamut.hpp>
+#include <csg.hpp>
+#include <csg_renderer.hpp>
+#include <points.hpp>
+#include <chromaticity.hpp>
+#include <future>
 
 class App
 {
@@ -22,6 +27,8 @@ class App
     float gamutOpacity = 1.0f;
 
     float spaceInterpolant = 0.0f, targetSpaceInterpolant = 0.0;
+    // Size of the RGB cube in RGB space, in Lab units
+    float rgbExtent = 100.0f;
     float startTime = -1.0f;
     bool isAnimateSpace = false;
 
@@ -29,6 +36,70 @@ class App
         textBcaps;
     uint8_t intersectionHash = 0;  // each bit represent which gamut is intersecting
     std::unordered_map<uint8_t, std::shared_ptr<Mesh>> intersectionMeshes;
+    // Exact intersections computed on a worker thread, keyed by intersection hash
+    std::future<std::vector<std::pair<uint8_t, std::shared_ptr<Mesh>>>> pendingIntersection;
+    std::unordered_set<uint8_t> failedIntersections;
+    // Approximate intersections shown until the exact result is ready
+    std::unordered_map<uint8_t, std::shared_ptr<Mesh>> previewMeshes;
+    bool isPreviewBooleans = true;
+    int previewResolution = 48;
+    // Intersections of the coarsest gamut levels, posted by the worker before the exact result
+    std::vector<std::pair<uint8_t, std::shared_ptr<Mesh>>> coarseIntersections;
+    std::mutex coarseIntersectionsMutex;
+    // Transform of the first selected gamut when the running intersection started
+    Transform3f pendingTransform = Transform3f::Identity();
+    // Draws gamuts at the coarsest level whose error stays within lodTolerance pixels
+    bool isLevelOfDetail = true;
+    float lodTolerance = 1.0f;
+    // Draws every gamut resampled on the shared icosphere instead of its own triangulation
+    bool isSphericalView = false;
+    // Shows the Lab and RGB value of the gamut surface under the cursor
+    bool isHoverReadout = true;
+    // Shows constant-lightness cross sections of the gamuts in an overlay panel
+    bool isSliceView = false;
+    float sliceLightness = 50.0f;
+    // Cross section loops of every gamut at slicedLightness
+    std::vector<std::vector<LightnessSlicer::Polygon>> sliceLoops;
+    float slicedLightness = -1.0f;
+    // Colors the other gamuts by signed distance to this gamut, -1 for Lab colors. Only shown in
+    // Lab space, the RGB morph reads positions from the colors.
+    int heatmapTarget = -1;
+    // Distance in Lab units where the ramp saturates
+    float heatmapRange = 10.0f;
+    // Target, range and gamut count the current colors were computed for
+    int coloredTarget = -1;
+    float coloredRange = 0.0f;
+    size_t coloredCount = 0u;
+    // Shows constant-hue leaves of the gamuts in an overlay panel, and optionally their cusp
+    // lines over the scene
+    bool isHueView = false;
+    bool isCuspOverlay = true;
+    // Hue angle of the leaves in degrees
+    float leafHue = 0.0f;
+    // Leaf outlines of every gamut at leafedHue
+    std::vector<std::vector<HueSlicer::Polygon>> leafOutlines;
+    float leafedHue = -1.0f;
+    // Cusp of every gamut at each whole degree of hue, computed once per gamut
+    std::vector<std::vector<Vector3f>> cuspLines;
+    // Shows the footprints of the gamuts on a chromaticity diagram in an overlay panel
+    bool isChromaticityView = false;
+    chromaticity::Diagram diagram = chromaticity::Diagram::xy;
+    // Footprint of every gamut on each diagram, computed once per gamut
+    std::vector<std::array<chromaticity::Footprint, 2>> footprints;
+    // Overlap of every active gamut with the first active one, and the footprint of all of them,
+    // for the selection and diagram they were computed for
+    std::vector<double> overlapAreas;
+    chromaticity::Footprint selectionFootprint;
+    std::vector<bool> footprintSelection;
+    chromaticity::Diagram footprintDiagram = chromaticity::Diagram::xy;
+    // File of Lab colors to classify against the loaded gamuts, and the last result in brief
+    char pointsPath[256] = "points.csv";
+    std::string pointsSummary;
+    // Summary of a classification running on a worker thread
+    std::future<std::string> pendingClassification;
+    // Draws intersections on the GPU with stencil CSG instead of computing meshes
+    bool isStencilIntersection = false;
+    std::unique_ptr<csg::StencilRenderer> stencilRenderer;
     struct Mouse
     {
         Vector2f pos = Vector2f::Zero();
@@ -44,6 +115,16 @@ class App
 
     std::unordered_set<fs::path> importedGamuts;
     std::vector<std::shared_ptr<Gamut::GamutMesh>> gamuts;
+    // Validation applied to gamuts loaded from now on
+    Gamut::Validation validation = Gamut::Validation::full;
+    // Gamuts loaded from now on are remeshed to edges of this length in Lab units, 0 keeps them
+    float remeshEdgeLength = 0.0f;
+    // CGAL surface meshes beyond this many bytes are released, least recently used first
+    size_t surfaceMeshBudget = size_t(256) << 20u;
+    // Memory held by CGAL surface meshes, as of the last trimSurfaceMeshes()
+    size_t surfaceMeshTotal = 0u;
+    // Memory held by their AABB trees, counted against the same budget
+    size_t aabbTreeTotal = 0u;
 
     App(Vector2f winSize);
     // Called before event processing
@@ -54,13 +135,58 @@ class App
     void event(const GLEQevent& event);
     void onMouseButton(int button, bool pressed);
     void loadGamutMesh(const fs::path& filepath);
+    // Reads a gamut with the current load settings, does not touch OpenGL
+    std::shared_ptr<Gamut::GamutMesh> readGamutMesh(const fs::path& filepath);
+    // Loads every .gam profile in the given directory that is not loaded yet, in parallel
+    void loadProfiles(const fs::path& directory);
     void switchSpace();
-    void intersectTwoMeshes(
-        std::shared_ptr<Mesh> a,
-        std::shared_ptr<Mesh> b,
-        uint8_t hash
-    );
+    // Intersects two meshes without touching OpenGL, returns null on failure
+    std::shared_ptr<Mesh> intersectTwoMeshes(std::shared_ptr<Mesh> a, std::shared_ptr<Mesh> b);
+    // Creates a mesh colored by its Lab coordinates
+    std::shared_ptr<Mesh> labMesh(const csg::Geometry& geom);
+    // Indices of the gamuts selected for intersection
+    std::vector<size_t> intersectionGamuts() const;
+    // Starts computing the exact intersection of the selected gamuts in the background
     void generateIntersectionMesh();
+    // Builds an approximate intersection from signed distance grids
+    void generatePreviewMesh();
+    // Picks up finished background intersections
+    void collectIntersections();
+    // Re-slices the gamuts in parallel if the lightness or the set of gamuts changed
+    void updateSlices();
+    // Draws the cross section panel
+    void drawSlicePanel();
+    // Recolors the gamuts if the heatmap target, its range, the gamuts or the color space changed
+    void updateHeatmap();
+    // Computes cusp lines of new gamuts, and re-cuts the leaves if the hue changed
+    void updateLeaves();
+    // Draws the hue leaf panel
+    void drawHuePanel();
+    // Draws the cusp lines projected over the scene
+    void drawCuspLines();
+    // Projects new gamuts, and recomputes the overlaps if the selection or diagram changed
+    void updateFootprints();
+    // Draws the chromaticity panel
+    void drawChromaticityPanel();
+    // Starts classifying the Lab colors in a file against all gamuts in the background,
+    // writing <stem>_classified.csv
+    void classifyPoints(const fs::path& path);
+    // Picks up the summary of a finished classification
+    void collectClassification();
+    // Gamut surface point under the cursor
+    struct Pick
+    {
+        size_t gamut;
+        Vector3f lab;
+    };
+    // Nearest visible gamut surface along the camera ray through the given screen point
+    std::optional<Pick> pickGamut(const Vector2f& screenPoint);
+    // Level of detail to draw the given gamut at from the current camera
+    Mesh& gamutLevel(size_t i);
+    // Meshes that may hold a CGAL surface mesh
+    std::vector<std::shared_ptr<Mesh>> allMeshes() const;
+    // Releases CGAL surface meshes until their memory fits in the budget
+    void trimSurfaceMeshes();
     // if no gamuts are set for intersection, or only one gamut is set, return false
     bool isValidIntersectionHash()
     {
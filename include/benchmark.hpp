@@ -0,0 +1,17 @@
+// Timing comparisons of geometry operations, run with `app --benchmark`
+#pragma once
+
+#include <app.hpp>
+
+namespace bench
+{
+    // Loads every profile in resources/profiles and runs all benchmarks
+    void run(App& app);
+    // Compares convex clipping against CGAL corefinement for every pair of loaded gamuts
+    void intersections(App& app);
+    // Times the volume/area/centroid kernels on every loaded gamut and on a multi-million
+    // triangle mesh made by repeating their triangles
+    void integrals(App& app);
+    // Remeshes every loaded gamut and compares corefinement of every pair before and after
+    void remeshing(App& app, float edgeLength = 5.0f);
+};
@@ -0,0 +1,99 @@
+// Gamut boundary descriptors, for fast in-gamut queries of many colors
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+
+/**
+ * @brief Segment maxima style boundary descriptor: directions from a center are divided into a
+ *        grid of lightness elevation rows and hue azimuth columns, and each segment keeps the
+ *        range of radii the surface reaches inside it along with the triangles that reach it.
+ *        A point farther out than the segment's range is outside and a point nearer in is on the
+ *        center's side, so most queries take one lookup. Points within the range are resolved
+ *        exactly against the segment's triangles.
+ */
+class BoundaryDescriptor
+{
+   public:
+    // Where a point lies relative to the surface, as far as the segment radii tell
+    enum class Containment
+    {
+        inside,
+        outside,
+        // Within the segment's radius range, needs an exact test
+        boundary
+    };
+
+   private:
+    struct Segment
+    {
+        // Nearest and farthest the surface comes to the center in this segment
+        float rMin = std::numeric_limits<float>::max();
+        float rMax = 0.0f;
+    };
+
+    Vector3f center = Vector3f::Zero();
+    int rows = 0;
+    int columns = 0;
+    std::vector<Segment> segments;
+    // Triangles reaching each segment, segment i holds
+    // segmentTriangles[segmentStarts[i]..segmentStarts[i + 1])
+    std::vector<uint32_t> segmentStarts;
+    std::vector<uint32_t> segmentTriangles;
+    // Whether the center is inside the surface, so points nearer than rMin are too
+    bool isCenterInside = true;
+
+   public:
+    BoundaryDescriptor() = default;
+    /**
+     * @brief Builds the descriptor of a closed Lab triangle mesh, triangles are measured in
+     *        parallel and each row of segments is filled in parallel
+     *
+     * @param vertices mesh vertices as (L*, a*, b*)
+     * @param triangles mesh triangles
+     * @param center point the segments are arranged around, the gamut center
+     * @param rows segments along lightness elevation, from +L* to -L*
+     * @param columns segments around the hue circle
+     */
+    BoundaryDescriptor(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        const Vector3f& center,
+        int rows = 64,
+        int columns = 128
+    );
+
+    bool empty() const { return this->segments.empty(); }
+    // Constant time classification from the segment radii
+    Containment classify(const Vector3f& lab) const;
+    // Constant time signed distance estimate, positive outside: the radial distance to the
+    // middle of the segment's radius range
+    float approximateDistance(const Vector3f& lab) const;
+
+    // Exact containment, classify with a ray parity test against the segment's triangles
+    // for points in the boundary range
+    bool contains(
+        const Vector3f& lab,
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles
+    ) const;
+    // Distance signed by a containment the caller already knows, positive outside: the
+    // estimate for points farther from the segment's radius range than its width, the exact
+    // distance to the nearest triangle otherwise
+    float signedDistance(
+        const Vector3f& lab,
+        bool isInside,
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles
+    ) const;
+
+   private:
+    // Row and column of the segment holding a direction
+    std::pair<int, int> segmentOf(const Vector3f& direction) const;
+    // Number of surface crossings along the ray from a point away from the center
+    int crossings(
+        const Vector3f& lab,
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles
+    ) const;
+};
@@ -0,0 +1,57 @@
+// Bounding volume hierarchy over triangle meshes, for ray queries such as cursor picking
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+
+/**
+ * @brief Binary hierarchy of axis-aligned boxes built with the binned surface area heuristic.
+ *        Triangles are stored in leaf order as a corner and two edges in structure-of-arrays
+ *        layout, so each leaf's triangles are tested against a ray together in SIMD lanes.
+ */
+class Bvh
+{
+   public:
+    // Triangles tested together, leaves hold at most this many
+    static constexpr uint32_t lanes = 4u;
+
+    struct Hit
+    {
+        // Index into the triangles the hierarchy was built from
+        uint32_t triangle;
+        float distance;
+        // Weights of the second and third triangle corner
+        Vector2f barycentric;
+    };
+
+   private:
+    struct Node
+    {
+        Vector3f bbMin;
+        // First child for inner nodes, first leaf slot for leaves
+        uint32_t first;
+        Vector3f bbMax;
+        // Number of triangles, zero for inner nodes whose children are first and first + 1
+        uint32_t count;
+    };
+
+    std::vector<Node> nodes;
+    // Triangle index of every leaf slot
+    std::vector<uint32_t> order;
+    // Corner and edges of the triangle in every leaf slot, padded by lanes - 1 slots at the end
+    std::vector<float> corner[3], edge1[3], edge2[3];
+
+   public:
+    bool empty() const { return this->nodes.empty(); }
+    // Builds the hierarchy, vertices should be in the space rays will be given in
+    void build(const std::vector<Vector3f>& vertices, const std::vector<Vector3u>& triangles);
+    // Updates bounds for moved vertices, keeping the tree structure. Cheap, but the tree loses
+    // quality if the triangles move relative to each other.
+    void refit(const std::vector<Vector3f>& vertices, const std::vector<Vector3u>& triangles);
+    // Nearest intersection with either side of the triangles
+    std::optional<Hit> intersect(const Ray& ray) const;
+
+   private:
+    // Fills the leaf-ordered triangle arrays from order
+    void gather(const std::vector<Vector3f>& vertices, const std::vector<Vector3u>& triangles);
+};
@@ -0,0 +1,52 @@
+// Gamut footprints on the CIE 1931 xy and CIE 1976 u'v' chromaticity diagrams
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+#include <gamut.hpp>
+#include <polygon.hpp>
+
+namespace chromaticity
+{
+    enum class Diagram
+    {
+        // CIE 1931 x, y
+        xy,
+        // CIE 1976 u', v'
+        uv
+    };
+
+    // Chromaticity coordinates of an XYZ color, NaN for black
+    Vector2f fromXYZ(const Vector3f& XYZ, Diagram diagram);
+    // Spectral locus from 380 to 700 nm, closed by the line of purples
+    const polygon::Loop& locus(Diagram diagram);
+
+    // Chromaticities of a set of colors and the convex region they span
+    struct Footprint
+    {
+        // Distinct chromaticities sorted by x, then y, so hulls and merges take linear time
+        std::vector<Vector2f> sorted;
+        // Counter-clockwise convex hull
+        polygon::Loop hull;
+        double area = 0.0;
+
+        bool empty() const { return this->hull.empty(); }
+    };
+
+    /**
+     * @brief Projects Lab colors onto a chromaticity diagram in parallel, sorts the projections
+     *        once and builds their hull. Argyll gamut surfaces are in ICC PCS Lab, relative to
+     *        D50.
+     */
+    Footprint project(
+        const std::vector<Vector3f>& labs,
+        Diagram diagram,
+        Gamut::Illuminant white = Gamut::Illuminant::D50
+    );
+    // Footprint of the union of several, merging their sorted points in linear time
+    Footprint combine(const std::vector<const Footprint*>& footprints);
+    // Convex hull of points sorted by x, then y, by Andrew's monotone chain
+    polygon::Loop hull(const std::vector<Vector2f>& sorted);
+    // Area of the intersection of two footprints
+    double overlapArea(const Footprint& a, const Footprint& b);
+}
@@ -0,0 +1,80 @@
+// Pairwise volume coverage between gamuts, for comparing whole profile libraries
+#pragma once
+
+#include <util.hpp>
+#include <mesh.hpp>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Fraction of each profile's gamut volume that lies inside each other profile's gamut.
+ *        Intersections are symmetric, so every unordered pair is computed once by a pool of
+ *        workers pulling pairs from a shared queue. Results can be written out and read back,
+ *        matched by mesh content, so adding a profile to a library only computes the new pairs.
+ */
+class CoverageMatrix
+{
+   public:
+    std::vector<std::shared_ptr<Mesh>> profiles;
+
+   private:
+    // Volume of each profile
+    std::vector<double> volumes;
+    // Intersection volume of each pair of profile indices, NaN where the boolean failed
+    std::unordered_map<UnorderedPair<size_t>, double> intersections;
+    std::mutex intersectionsMutex;
+
+   public:
+    CoverageMatrix(const std::vector<std::shared_ptr<Mesh>>& profiles);
+
+    // Computes every pair that is not cached yet, on the given number of threads
+    void compute(size_t threads = std::thread::hardware_concurrency());
+    // Volume of the intersection of profiles a and b, NaN if not computed or failed
+    double intersectionVolume(size_t a, size_t b) const;
+    // Fraction of profile a's volume inside profile b
+    double coverage(size_t a, size_t b) const;
+
+    // Writes the matrix as CSV, row a column b holds the fraction of a inside b
+    void writeCsv(const fs::path& path) const;
+    // Writes profile volumes and pair intersection volumes, keyed by mesh content hash
+    void writeBinary(const fs::path& path) const;
+    // Reuses intersection volumes from a file written by writeBinary, returns pairs reused
+    size_t readBinary(const fs::path& path);
+};
+
+/**
+ * @brief Area of each profile's constant-lightness cross section, and of each pair's
+ *        intersection, at evenly spaced L* levels. Pair areas come from 2D polygon Booleans on
+ *        the slices, so the curves and the volume estimates integrated from them cost a small
+ *        fraction of the 3D Booleans behind CoverageMatrix.
+ */
+class CoverageCurves
+{
+   public:
+    std::vector<std::shared_ptr<Mesh>> profiles;
+    // Lightness of each level, midpoints of equal steps over the profiles' L* range
+    std::vector<float> levels;
+
+   private:
+    // L* step between levels
+    float step = 0.0f;
+    // Cross section area of each profile at each level
+    std::vector<std::vector<double>> areas;
+    // Intersection area of each pair of profile indices at each level
+    std::unordered_map<UnorderedPair<size_t>, std::vector<double>> intersections;
+
+   public:
+    CoverageCurves(const std::vector<std::shared_ptr<Mesh>>& profiles, size_t levelCount = 100u);
+
+    // Slices every profile at every level and intersects every pair, in parallel
+    void compute();
+    // Area of the intersection of profiles a and b at a level, the profile's own area if a == b
+    double area(size_t a, size_t b, size_t level) const;
+    // Midpoint rule estimate of the volume of the intersection of profiles a and b
+    double volume(size_t a, size_t b) const;
+    // Estimated fraction of profile a's volume inside profile b
+    double coverage(size_t a, size_t b) const;
+
+    // Writes one row per level with the area of every profile and every pair
+    void writeCsv(const fs::path& path) const;
+};
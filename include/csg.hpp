@@ -0,0 +1,72 @@
+// Boolean operations on closed triangle meshes
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+#include <mesh.hpp>
+
+namespace csg
+{
+    // Indexed triangle geometry produced by a boolean operation
+    struct Geometry
+    {
+        std::vector<Vector3f> vertices;
+        std::vector<Vector3u> triangles;
+
+        bool empty() const { return this->triangles.empty(); }
+    };
+
+    // How two closed meshes are positioned relative to each other
+    enum class Relation
+    {
+        // Surfaces cross, a boolean operation is needed
+        overlapping,
+        // Volumes do not overlap at all
+        disjoint,
+        // a lies entirely inside b
+        aInsideB,
+        // b lies entirely inside a
+        bInsideA
+    };
+
+    /**
+     * @brief Checks if a closed triangle mesh is convex by testing every edge for a reflex
+     *        dihedral angle, which for a closed surface is equivalent to global convexity
+     *
+     * @param vertices mesh vertices
+     * @param triangles mesh triangles, consistently wound
+     * @param tolerance how far (in mesh units) a neighboring vertex may poke out of a face plane
+     * @return true if the mesh is closed and convex within tolerance
+     */
+    bool isConvex(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        float tolerance = 0.5f
+    );
+
+    // Returns +1 if triangles are wound counter-clockwise seen from outside, -1 otherwise
+    float orientation(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles
+    );
+
+    /**
+     * @brief Classifies two closed meshes with cheap tests (bounding boxes, surface intersection,
+     *        then point-in-mesh on a single vertex) to skip corefinement when possible. Surfaces
+     *        meeting only in shared vertices, such as a common black point, do not count as
+     *        crossing.
+     */
+    Relation classify(Mesh& a, Mesh& b);
+
+    // Intersection of two convex meshes, computed by clipping a against every face plane of b
+    Geometry intersectConvex(const Mesh& a, const Mesh& b);
+
+    // Intersection of two meshes with CGAL corefinement, nullopt on failure
+    std::optional<Geometry> intersectCorefine(Mesh& a, Mesh& b);
+
+    // Copies a surface mesh without removed elements (call collect_garbage() first) to arrays
+    Geometry toGeometry(const SurfaceMesh& mesh);
+
+    // Intersection of two meshes, using the convex fast path when both meshes are convex
+    std::optional<Geometry> intersect(Mesh& a, Mesh& b);
+};
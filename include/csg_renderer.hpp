@@ -0,0 +1,57 @@
+// Image-space boolean rendering with the depth and stencil buffers
+#pragma once
+
+#include <gfx.hpp>
+#include <mesh.hpp>
+#include <shader_program.hpp>
+
+namespace csg
+{
+    /**
+     * @brief Draws the intersection of closed meshes without computing its geometry, following
+     *        Goldfeather's algorithm: every front-facing layer of every mesh is a candidate
+     *        surface, kept where the parity of the other meshes' surfaces in front of it is odd
+     *        (inside all of them), and the nearest surviving candidate is composited.
+     *
+     *        Costs O(n^2 * layers) passes for n meshes but needs no geometry processing, so it
+     *        reacts instantly to selection changes and has no limit on n.
+     */
+    class StencilRenderer
+    {
+       public:
+        // Upper bound on the number of front-facing layers visited per mesh
+        int maxLayers = 16;
+        // Number of candidate layers processed in the last call
+        int layersDrawn = 0;
+
+       private:
+        // Fullscreen passes: discarding candidates and compositing
+        ShaderProgram program;
+        gfx::Texture color, depthStencil;
+        GLuint fbo = GL_INVALID_INDEX, vao = GL_INVALID_INDEX, query = GL_INVALID_INDEX;
+        Vector2i size = Vector2i::Zero();
+
+       public:
+        StencilRenderer();
+        StencilRenderer(const StencilRenderer&) = delete;
+        ~StencilRenderer();
+
+        /**
+         * @brief Draws the intersection of the given meshes into the bound framebuffer, depth
+         *        tested against what it already contains
+         *
+         * @param meshes closed meshes to intersect, each drawn with its own transform
+         * @param meshProgram program the meshes draw with, its uniforms already set
+         */
+        void drawIntersection(
+            const std::vector<std::shared_ptr<Mesh>>& meshes,
+            ShaderProgram& meshProgram
+        );
+
+       private:
+        // Matches the offscreen targets to the viewport size
+        void resize(const Vector2i& viewport);
+        // Draws a fullscreen triangle, compositing the offscreen target or discarding candidates
+        void fullscreen(bool composite);
+    };
+}
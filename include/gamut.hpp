@@ -4,6 +4,16 @@
 #include <vecmath.hpp>
 #include <unordered_map>
 #include <mesh.hpp>
+#include <integrals.hpp>
+#include <lod.hpp>
+#include <remesh.hpp>
+#include <bvh.hpp>
+#include <slice.hpp>
+#include <hue.hpp>
+#include <boundary.hpp>
+#include <occupancy.hpp>
+#include <winding.hpp>
+#include <spherical.hpp>
 
 
 namespace Gamut
@@ -14,11 +24,12 @@ namespace Gamut
         std::string originator;
         std::string created;
         std::string color_rep;
-        Vector3f gamut_center;
-        Vector3f cspace_white;
-        Vector3f gamut_white;
-        Vector3f cspace_black;
-        Vector3f gamut_black;
+        // Center of the gamut, the centroid if the header has none
+        Vector3f gamut_center = Vector3f::Zero();
+        Vector3f cspace_white = Vector3f::Zero();
+        Vector3f gamut_white = Vector3f::Zero();
+        Vector3f cspace_black = Vector3f::Zero();
+        Vector3f gamut_black = Vector3f::Zero();
     };
 
     enum class Illuminant
@@ -64,6 +75,42 @@ namespace Gamut
                                     { -0.9692660, 1.8760108, 0.0415560 },
                                     { 0.0556434, -0.2040259, 1.0572252 } };
 
+    // How thoroughly gamut surfaces are checked and repaired when they are built
+    enum class Validation
+    {
+        // Use the surface as loaded
+        none,
+        // Edge-hash topology check, repairing isolated and non-manifold vertices with CGAL only
+        // when it finds defects
+        topology,
+        // Topology plus self-intersection, skipped for content already known to be clean
+        full
+    };
+
+    // Content hashes of gamut surfaces that passed full validation, persisted across runs
+    class ValidationCache
+    {
+       public:
+        // File the hashes are read from and appended to
+        fs::path path = "validation.cache";
+
+       private:
+        std::unordered_set<uint64_t> clean;
+        bool isLoaded = false;
+        std::mutex mutex;
+
+       public:
+        // True if content with the given hash passed full validation before
+        bool isClean(uint64_t hash);
+        // Records that content with the given hash passed full validation
+        void markClean(uint64_t hash);
+
+       private:
+        void load();
+    };
+
+    // CIE Lab to XYZ relative to the white of the given illuminant, without adaptation
+    Vector3f LABtoXYZ(const Vector3f& lab, Illuminant ill = Illuminant::D65);
     Vector3f LABtoRGB(const Vector3f& lab, Illuminant ill = Illuminant::D65);
     Vector3f XYZtoRGB(Vector3f& color);
 
@@ -72,8 +119,87 @@ namespace Gamut
        public:
         std::shared_ptr<GamutData> data;
         bool isWireframe = false;
+        // Volume, surface area and centroid, computed on load
+        MeshIntegrals integrals;
+        Validation validation = Validation::full;
+        // Simplified copies for distant rendering and quick booleans, finest first
+        std::vector<std::shared_ptr<Mesh>> levels;
+        // Bound on each level's distance from the full surface, in Lab units
+        std::vector<float> levelErrors;
+        // Index of the triangles by lightness, for cross sections
+        LightnessSlicer slicer;
+        // Index of the triangles by hue angle, for hue leaves and cusp lines
+        HueSlicer hueSlicer;
+        // Segment maxima around the gamut center, for in-gamut queries
+        BoundaryDescriptor boundary;
+        // Inside, outside and boundary cells over the bounds, for in-gamut queries
+        OccupancyGrid occupancy;
+        // Winding numbers for inside tests, built only for surfaces with holes
+        WindingTree winding;
+        // Surface along the shared icosphere directions from the gamut center, and the same
+        // points as a mesh drawn with the index buffer all resampled gamuts share
+        spherical::Sampling sampling;
+        std::shared_ptr<Mesh> resampled;
 
        public:
-        GamutMesh(const std::string& filepath, ShaderProgram& program);
+        GamutMesh(
+            const std::string& filepath,
+            ShaderProgram& program,
+            Validation validation = Validation::full,
+            float remeshEdgeLength = 0.0f
+        );
+
+        /**
+         * @brief Picks the coarsest level whose error covers at most the given number of pixels,
+         *        the full mesh if no level is coarse enough. Levels keep the transform copied
+         *        to them when the gamut is loaded, and need it copied again if that changes.
+         *
+         * @param pixelsPerUnit screen pixels per Lab unit where the mesh is drawn
+         * @param pixelTolerance largest visible error in pixels
+         */
+        Mesh& levelFor(float pixelsPerUnit, float pixelTolerance = 1.0f);
+
+        /**
+         * @brief Nearest hit of a world-space ray with the surface as drawn, its vertices morphed
+         *        from Lab towards extent * RGB by spaceInterp like the mesh shader does. The
+         *        hierarchy is rebuilt when the morph changes and refit when only the transform
+         *        does.
+         */
+        std::optional<Bvh::Hit> pick(const Ray& ray, float spaceInterp, float extent);
+        // Lab value of the surface point a pick hit
+        Vector3f labAt(const Bvh::Hit& hit) const;
+        // Whether a Lab color is inside the gamut
+        bool contains(const Vector3f& lab) const;
+        // Distance of a Lab color from the gamut surface, negative inside
+        float signedDistance(const Vector3f& lab) const;
+        // Same, signed by a containment the caller has already tested
+        float signedDistance(const Vector3f& lab, bool isInside) const;
+        // Signed distances of many Lab colors, from batched closest-point queries through the
+        // AABB tree with signs from contains()
+        std::vector<float> signedDistances(const std::vector<Vector3f>& labs);
+        // Colors this gamut and its levels by each vertex's signed distance to another gamut,
+        // blue inside it through gray on its surface to red outside, saturating at range
+        void colorByDistance(GamutMesh& other, float range);
+        // Restores the colors derived from the Lab coordinates of this gamut and its levels
+        void resetColors();
+
+       protected:
+        // Builds the surface mesh and repairs defects in the profile's triangulation
+        void buildSurfaceMesh() override;
+
+       private:
+        // Hierarchy over the drawn triangles in world space, and what it was built for
+        Bvh bvh;
+        Matrix4f bvhTransform = Matrix4f::Zero();
+        float bvhSpaceInterp = -1.0f;
+
+        // This mesh followed by its levels and its resampled surface
+        std::vector<Mesh*> withLevels();
+        // Fills sampling and resampled from the current surface and gamut center
+        void resample();
+        // Replaces the geometry with an isotropic remesh, cached next to the source file
+        void remeshSurface(const fs::path& source, float edgeLength);
+        // Fills levels by simplifying the loaded surface
+        void buildLevels();
     };
 };
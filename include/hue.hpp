@@ -0,0 +1,59 @@
+// Constant-hue cross sections and cusp lines of Lab surfaces
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+
+/**
+ * @brief Cuts a closed Lab triangle mesh with half-planes of constant hue angle, bounded by the
+ *        L* axis. Triangles are sorted into bins by the hue range they span, so a leaf only
+ *        visits the bin holding its hue. Triangles around the neutral axis span every hue and
+ *        are visited by every leaf.
+ */
+class HueSlicer
+{
+   public:
+    // Leaf outline in the chroma-lightness plane, (C*, L*). Outlines that reach the L* axis are
+    // closed along it, the first point is not repeated at the end.
+    using Polygon = std::vector<Vector2f>;
+
+   private:
+    float binWidth = 1.0f;
+    // Triangles overlapping each hue bin, bin i holds binTriangles[binStarts[i]..binStarts[i + 1])
+    std::vector<uint32_t> binStarts;
+    std::vector<uint32_t> binTriangles;
+    // Triangles whose a*b* projection contains the neutral axis
+    std::vector<uint32_t> axisTriangles;
+
+   public:
+    HueSlicer() = default;
+    // Indexes the triangles of a mesh whose vertices are (L*, a*, b*)
+    HueSlicer(const std::vector<Vector3f>& vertices, const std::vector<Vector3u>& triangles);
+
+    /**
+     * @brief Outlines where the surface crosses the half-plane of a hue angle
+     *
+     * @param vertices the vertices the slicer was built with
+     * @param triangles the triangles the slicer was built with
+     * @param hue hue angle in radians, counter-clockwise from +a*
+     */
+    std::vector<Polygon> leaf(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        float hue
+    ) const;
+
+    /**
+     * @brief Point of largest chroma on the leaves of evenly spaced hues, computed in parallel
+     *
+     * @param vertices the vertices the slicer was built with
+     * @param triangles the triangles the slicer was built with
+     * @param count number of hues, starting at 0
+     * @return Lab cusp of every hue, the neutral axis point where a leaf is empty
+     */
+    std::vector<Vector3f> cusps(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        size_t count = 360u
+    ) const;
+};
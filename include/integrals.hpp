@@ -0,0 +1,29 @@
+// Integral properties of closed triangle meshes: volume, surface area and centroid
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+
+struct MeshIntegrals
+{
+    // Enclosed volume, positive regardless of winding
+    double volume = 0.0;
+    // Total surface area
+    double area = 0.0;
+    // Center of mass of the enclosed solid
+    Vector3f centroid = Vector3f::Zero();
+};
+
+/**
+ * @brief Computes volume (sum of signed tetrahedra against a reference point), surface area and
+ *        centroid of a closed triangle mesh. Triangles are processed in parallel chunks, each
+ *        chunk in fixed-width lanes so the arithmetic vectorizes.
+ *
+ * @param vertices mesh vertices
+ * @param triangles mesh triangles, consistently wound
+ * @return MeshIntegrals
+ */
+MeshIntegrals integrate(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+);
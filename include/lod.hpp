@@ -0,0 +1,48 @@
+// Simplified versions of meshes for distant rendering and quick boolean previews
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+#include <camera.hpp>
+#include <csg.hpp>
+
+namespace lod
+{
+    // Target of one simplified level
+    struct LevelConfig
+    {
+        // Fraction of the input's edges to keep
+        float edgeRatio;
+        // Largest distance a collapsed vertex may be placed from the input surface
+        float maxError;
+    };
+
+    // Three levels, each halving the previous one, for Lab-sized meshes
+    const std::vector<LevelConfig> defaultLevels{
+        { 0.5f, 0.5f },
+        { 0.25f, 1.0f },
+        { 0.125f, 2.0f },
+    };
+
+    /**
+     * @brief Simplifies a mesh by edge collapse with Lindstrom-Turk costs and placements, where
+     *        placements farther than maxError from the input are rejected so every level stays
+     *        within its error of the full mesh. Levels are built in parallel, each from the input.
+     *
+     * @param vertices mesh vertices
+     * @param triangles mesh triangles, must form a valid polygon mesh
+     * @param levels targets, finest first
+     * @param minTriangles levels below this size, or not clearly smaller than the previous level,
+     *        are left out along with all coarser ones
+     * @return one geometry per level that was kept
+     */
+    std::vector<csg::Geometry> simplify(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        const std::vector<LevelConfig>& levels = defaultLevels,
+        size_t minTriangles = 64u
+    );
+
+    // Screen pixels covered by one world unit at the given world position
+    float pixelsPerUnit(const Camera& cam, const Vector3f& position);
+}
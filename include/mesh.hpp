@@ -2,14 +2,30 @@
 #include <util.hpp>
 #include <vecmath.hpp>
 #include <shader_program.hpp>
+#include <topology.hpp>
 #include <CGAL/Simple_cartesian.h>
 #include <CGAL/Surface_mesh.h>
 #include <CGAL/polygon_mesh_processing.h>
+#include <CGAL/AABB_tree.h>
+#include <CGAL/AABB_traits.h>
+#include <CGAL/AABB_face_graph_triangle_primitive.h>
+#include <mutex>
 
 using Kernel = CGAL::Exact_predicates_inexact_constructions_kernel;
 using Point3 = Kernel::Point_3;
 using SurfaceMesh = CGAL::Surface_mesh<Point3>;
 namespace PMP = CGAL::Polygon_mesh_processing;
+using AabbPrimitive = CGAL::AABB_face_graph_triangle_primitive<SurfaceMesh>;
+using AabbTree = CGAL::AABB_tree<CGAL::AABB_traits<Kernel, AabbPrimitive>>;
+
+// Element buffer shared by meshes with identical triangles, created by the first of them drawn
+// and freed with the last
+struct SharedIndexBuffer
+{
+    GLuint ebo = 0u;
+
+    ~SharedIndexBuffer();
+};
 
 class Mesh
 {
@@ -22,10 +38,27 @@ class Mesh
     std::vector<Vector3f> colors;
     std::vector<Vector3u> triangles;
     Transform3f transform = Transform3f::Identity();
+    // Cached result of convexity detection, reset when geometry changes
+    std::optional<bool> convex;
+    // Cached edge topology check, reset when geometry changes
+    std::optional<TopologyReport> topology;
+    // Index buffer to draw with instead of an own one, set before the first draw
+    std::shared_ptr<SharedIndexBuffer> sharedIndices;
+
+   protected:
+    // Exact-predicate copy of the geometry for CGAL, built on first use by getSurfaceMesh()
     SurfaceMesh surfaceMesh;
 
    private:
+    // Face hierarchy over surfaceMesh shared by containment and distance queries, built on first
+    // use by getAabbTree() and dropped with the surface mesh
+    std::unique_ptr<AabbTree> aabbTree;
+    // Guards surfaceMesh and aabbTree
+    mutable std::mutex surfaceMeshMutex;
+    std::chrono::steady_clock::time_point surfaceMeshUsed;
     GLuint vao, vbo, ebo, vboColors;
+    // GPU buffers are created on first draw, so meshes can be built off the main thread
+    bool hasBuffers = false;
 
    public:
     Mesh(ShaderProgram& _program) : program(_program) {}
@@ -37,8 +70,52 @@ class Mesh
         ShaderProgram& _program
     );
     Mesh(Mesh& other);
+    virtual ~Mesh();
     void setVertexColor(const Vector3f& color);
+    // Re-uploads colors after they were changed in place, leaving the other buffers alone
+    void uploadColors();
+    // Recomputes bbMin and bbMax from vertices
+    void computeBounds();
+    // Returns the CGAL surface mesh, building it first if it was never built or was released.
+    // Repairs may split or renumber its vertices, so they are matched to vertices by position.
+    SurfaceMesh& getSurfaceMesh();
+    // True if the CGAL surface mesh is currently built
+    bool hasSurfaceMesh() const;
+    // Frees the CGAL surface mesh and its AABB tree, they are rebuilt on next use. Must not be
+    // called while another thread holds a reference from getSurfaceMesh() or getAabbTree()
+    void releaseSurfaceMesh();
+    // Approximate memory held by the CGAL surface mesh in bytes
+    size_t surfaceMeshBytes() const;
+    // Returns the AABB tree over the CGAL surface mesh, building both first if needed. Queries
+    // through the tree are thread-safe once it is built.
+    const AabbTree& getAabbTree();
+    // Approximate memory held by the AABB tree in bytes, zero if it is not built
+    size_t aabbTreeBytes() const;
+    // Whether a point is inside the closed surface, using the shared AABB tree
+    bool isInside(const Vector3f& point);
+    // Nearest point on the surface, using the shared AABB tree
+    Vector3f closestPoint(const Vector3f& point);
+    // Nearest surface points of many points, queried through the shared AABB tree in parallel
+    std::vector<Vector3f> closestPoints(const std::vector<Vector3f>& points);
+    // Drops everything derived from vertices and triangles: cached checks, the CGAL surface mesh
+    // and its AABB tree. Call after changing the geometry.
+    void geometryChanged();
+    // Time of the last getSurfaceMesh() or getAabbTree() call
+    std::chrono::steady_clock::time_point surfaceMeshLastUsed() const { return surfaceMeshUsed; }
+    // Returns true if the mesh is closed and (nearly) convex, result is cached
+    bool isConvex();
+    // Returns the defects found by checkTopology(), result is cached
+    const TopologyReport& getTopology();
+    // Hash of vertex and triangle data, identifies geometry across runs
+    uint64_t contentHash() const;
+    // Stored in every file keyed by contentHash, bump it when the hash changes
+    static constexpr uint32_t contentHashVersion = 1u;
     void generateBuffers();
     void draw(bool isWireframe = false);
-    ~Mesh();
+    // Draws even if inactive, for multi-pass techniques that need the mesh regardless
+    void drawElements(bool isWireframe = false);
+
+   protected:
+    // Fills surfaceMesh from vertices and triangles
+    virtual void buildSurfaceMesh();
 };
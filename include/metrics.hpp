@@ -0,0 +1,77 @@
+// Shape similarity between gamuts, for clustering and deduplicating profile libraries
+#pragma once
+
+#include <util.hpp>
+#include <mesh.hpp>
+
+/**
+ * @brief Surface distances and volume differences between every pair of profiles. Each surface
+ *        is sampled once, area-weighted at a configurable density, and the samples of one
+ *        profile are measured against the other through its shared AABB tree, in parallel.
+ *        Results are kept per pair of mesh contents, so duplicate profiles and pairs read back
+ *        from file are not measured again.
+ */
+class SimilarityMatrix
+{
+   public:
+    // Distances between the surfaces of two profiles a and b, in Lab units
+    struct Metrics
+    {
+        // Largest distance from a sample of a to the surface of b, and the other way round
+        double maxAB = 0.0, maxBA = 0.0;
+        // Mean distance from the samples of a to the surface of b, and the other way round
+        double meanAB = 0.0, meanBA = 0.0;
+
+        // Symmetric approximate Hausdorff distance
+        double hausdorff() const { return std::max(this->maxAB, this->maxBA); }
+        // Mean surface distance over both directions
+        double meanDistance() const { return (this->meanAB + this->meanBA) / 2.0; }
+        // The same metrics seen from b
+        Metrics swapped() const { return { this->maxBA, this->maxAB, this->meanBA, this->meanAB }; }
+    };
+
+    std::vector<std::shared_ptr<Mesh>> profiles;
+    // Surface samples per square Lab unit
+    float density = 0.05f;
+    // Fewest samples taken from any surface
+    size_t minSamples = 1024u;
+
+   private:
+    // Pair of mesh content hashes, smaller first
+    struct Key
+    {
+        uint64_t first, second;
+
+        bool operator==(const Key& other) const = default;
+        /* hashable */ size_t _hash() const { return cantor(this->first, this->second); }
+    };
+
+    std::vector<double> volumes;
+    std::vector<uint64_t> hashes;
+    // Metrics of each pair of contents, oriented from Key::first to Key::second
+    std::unordered_map<Key, Metrics> results;
+
+   public:
+    SimilarityMatrix(const std::vector<std::shared_ptr<Mesh>>& profiles, float density = 0.05f);
+
+    // Samples every profile that takes part in a missing pair and measures those pairs
+    void compute();
+    // Metrics of profiles a and b oriented from a, empty if not computed
+    std::optional<Metrics> metrics(size_t a, size_t b) const;
+    // Volume difference of profiles a and b relative to the larger of the two, 0 for equal volumes
+    double volumeDifference(size_t a, size_t b) const;
+
+    // Writes one row per pair with its surface distances, volumes and volume difference
+    void writeCsv(const fs::path& path) const;
+    // Writes the metrics of every pair, keyed by mesh content hash
+    void writeBinary(const fs::path& path) const;
+    // Reuses metrics from a file written by writeBinary at the same density, returns pairs reused
+    size_t readBinary(const fs::path& path);
+
+   private:
+    Key key(size_t a, size_t b) const
+    {
+        return { std::min(this->hashes[a], this->hashes[b]),
+                 std::max(this->hashes[a], this->hashes[b]) };
+    }
+};
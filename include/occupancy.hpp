@@ -0,0 +1,86 @@
+// Voxel occupancy of closed surfaces, for classifying many points against a gamut
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+
+/**
+ * @brief Cells of a regular grid over a closed mesh's bounds, each marked inside, outside or
+ *        boundary in two bitsets. Boundary cells are the ones the surface may pass through;
+ *        every other cell is classified by scanline parity along x at its center. Points in
+ *        inside or outside cells are answered by a bit lookup, points in boundary cells by an
+ *        exact parity test against the triangles spanning their x row.
+ */
+class OccupancyGrid
+{
+   public:
+    enum class Cell : uint8_t
+    {
+        outside,
+        inside,
+        // The surface may pass through, needs an exact test
+        boundary
+    };
+
+    Vector3f origin = Vector3f::Zero();
+    float cellSize = 1.0f;
+    // Number of cells along each axis
+    Vector3i dims = Vector3i::Zero();
+
+   private:
+    // 64-bit words per x row, rows are padded so tasks filling different rows never share words
+    size_t rowWords = 0u;
+    std::vector<uint64_t> insideBits;
+    std::vector<uint64_t> boundaryBits;
+    // Triangles whose y-z bounds overlap each x row, row i holds
+    // rowTriangles[rowStarts[i]..rowStarts[i + 1])
+    std::vector<uint32_t> rowStarts;
+    std::vector<uint32_t> rowTriangles;
+
+   public:
+    OccupancyGrid() = default;
+    /**
+     * @brief Rasterizes a closed mesh: triangles mark boundary cells one z layer per task,
+     *        then the remaining cells are filled one x row per task
+     *
+     * @param vertices mesh vertices
+     * @param triangles mesh triangles
+     * @param bbMin lower corner of the mesh bounds
+     * @param bbMax upper corner of the mesh bounds
+     * @param cellSize edge length of the cubic cells
+     */
+    OccupancyGrid(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        const Vector3f& bbMin,
+        const Vector3f& bbMax,
+        float cellSize = 2.0f
+    );
+
+    bool empty() const { return this->insideBits.empty(); }
+    // Constant time classification by the cell holding a point, outside beyond the grid
+    Cell cell(const Vector3f& point) const;
+    // Exact containment, parity along x against the row's triangles for boundary cells
+    bool contains(
+        const Vector3f& point,
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles
+    ) const;
+    // Bytes held by the bitsets and the row index
+    size_t memoryBytes() const;
+
+   private:
+    size_t rowIndex(int y, int z) const { return (size_t)y + (size_t)this->dims.y() * z; }
+    // Word and bit of a cell in the bitsets
+    std::pair<size_t, uint64_t> bit(int x, int y, int z) const
+    {
+        return { this->rowIndex(y, z) * this->rowWords + (size_t)x / 64u, 1ull << (x % 64) };
+    }
+    // Sorted x coordinates where the line along x through (y, z) crosses the row's triangles
+    std::vector<float> crossings(
+        size_t row,
+        const Vector2f& yz,
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles
+    ) const;
+};
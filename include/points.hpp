@@ -0,0 +1,54 @@
+// Batch classification of measured Lab colors against gamuts
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+#include <gamut.hpp>
+
+namespace points
+{
+    // Gamuts a mask can hold, one bit each
+    constexpr size_t maxGamuts = 64u;
+
+    struct Classification
+    {
+        size_t gamutCount = 0u;
+        // Bit g of masks[p] is set if gamut g contains point p
+        std::vector<uint64_t> masks;
+        // Signed distance from point p to the surface of gamut g at p * gamutCount + g, negative
+        // inside. Empty if distances were not requested.
+        std::vector<float> distances;
+
+        float distance(size_t point, size_t gamut) const
+        {
+            return this->distances[point * this->gamutCount + gamut];
+        }
+    };
+
+    /**
+     * @brief Classifies points against every gamut with the gamuts' occupancy grids, boundary
+     *        descriptors and winding trees. Points are split into chunks processed in parallel,
+     *        each chunk runs through one gamut at a time so its structures stay in cache.
+     *
+     * @param points Lab colors
+     * @param gamuts gamuts to test against, at most maxGamuts
+     * @param withDistances also compute the signed distance to every surface
+     * @return Classification
+     */
+    Classification classify(
+        const std::vector<Vector3f>& points,
+        const std::vector<std::shared_ptr<Gamut::GamutMesh>>& gamuts,
+        bool withDistances = true
+    );
+
+    // Reads Lab colors from CSV with L, a and b in the first three columns, lines that do not
+    // parse such as headers are skipped. Files with the .lab extension hold raw float triplets.
+    std::vector<Vector3f> read(const fs::path& path);
+    // Writes one row per point with its Lab value, gamut mask and distance to each gamut
+    void writeCsv(
+        const fs::path& path,
+        const std::vector<Vector3f>& points,
+        const std::vector<std::shared_ptr<Gamut::GamutMesh>>& gamuts,
+        const Classification& result
+    );
+}
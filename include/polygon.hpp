@@ -0,0 +1,73 @@
+// Planar polygon regions and their Booleans, for comparing gamut cross sections
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+
+namespace polygon
+{
+    // Closed loop, the first point is not repeated at the end
+    using Loop = std::vector<Vector2f>;
+
+    /**
+     * @brief Area bounded by a set of oriented loops, counter-clockwise outlines and clockwise
+     *        holes. Loops wound the other way throughout, as slices of an outward-wound mesh
+     *        are, are turned around so the area is never negative. Edges are sorted into
+     *        horizontal bands by the y range they span, so point and edge queries only visit the
+     *        edges of the bands they overlap.
+     */
+    class Region
+    {
+        struct Edge
+        {
+            Vector2d from;
+            Vector2d to;
+        };
+
+        std::vector<Edge> edges;
+        double lo = 0.0;
+        double bandHeight = 1.0;
+        // Edges overlapping each band, band i holds bandEdges[bandStarts[i]..bandStarts[i + 1])
+        std::vector<uint32_t> bandStarts;
+        std::vector<uint32_t> bandEdges;
+        // Distance under which points count as lying on an edge
+        double tolerance = 0.0;
+
+       public:
+        Region() = default;
+        Region(const std::vector<Loop>& loops);
+
+        bool empty() const { return this->edges.empty(); }
+        // Area, never negative since loops are oriented on construction
+        double area() const;
+
+        // Area of the intersection of two regions
+        friend double intersectionArea(const Region& a, const Region& b);
+
+       private:
+        enum class Side
+        {
+            outside,
+            inside,
+            // On an edge running the same way as the given direction
+            alongBoundary,
+            // On an edge running against the given direction
+            againstBoundary,
+        };
+
+        // Band index range overlapping [y0, y1], empty if outside the region
+        std::pair<size_t, size_t> bands(double y0, double y1) const;
+        // Where p lies relative to the region, direction is used for points on the boundary
+        Side side(const Vector2d& p, const Vector2d& direction) const;
+        // Area of the parts of this region's boundary that lie inside other, by Green's theorem
+        double boundaryInside(const Region& other, bool countShared) const;
+    };
+
+    /**
+     * @brief Area of the intersection of two regions. The boundary of the intersection is made
+     *        of the parts of each boundary inside the other region, so edges are split where
+     *        they cross the other boundary and each piece is kept by testing its midpoint.
+     *        Shared boundary pieces are counted once, when both run the same way.
+     */
+    double intersectionArea(const Region& a, const Region& b);
+}
@@ -0,0 +1,42 @@
+// Isotropic remeshing, evening out triangle sizes before boolean operations
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+#include <csg.hpp>
+
+namespace remesh
+{
+    /**
+     * @brief Remeshes a closed surface towards uniform edges of the target length: long edges are
+     *        split first, then CGAL iterates splits, collapses, flips and tangential relaxation
+     *
+     * @param vertices mesh vertices
+     * @param triangles mesh triangles, must form a valid polygon mesh
+     * @param targetEdgeLength edge length to aim for, in mesh units
+     * @param iterations rounds of remeshing
+     * @return csg::Geometry
+     */
+    csg::Geometry isotropic(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        float targetEdgeLength,
+        int iterations = 3
+    );
+
+    // File the remeshed version of a source file is cached in, next to the source
+    fs::path cachePath(const fs::path& source);
+    // Reads a cached remesh, nullopt if missing or made from other content or edge length
+    std::optional<csg::Geometry> readCache(
+        const fs::path& path,
+        uint64_t sourceHash,
+        float targetEdgeLength
+    );
+    // Caches a remesh of content with the given hash
+    void writeCache(
+        const fs::path& path,
+        uint64_t sourceHash,
+        float targetEdgeLength,
+        const csg::Geometry& geom
+    );
+}
@@ -0,0 +1,58 @@
+// Signed distance grids, used for fast approximate boolean previews
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+#include <csg.hpp>
+
+// Signed distance samples on a regular lattice, negative inside
+class SdfGrid
+{
+   public:
+    // How two grids are combined
+    enum class Op
+    {
+        intersect,
+        unite,
+        subtract
+    };
+
+    Vector3f origin = Vector3f::Zero();
+    float cellSize = 1.0f;
+    // Number of lattice points along each axis
+    Vector3i dims = Vector3i::Zero();
+    // Distances are exact within band cells of the surface and clamped to +-band beyond
+    int band = 2;
+    std::vector<float> values;
+
+    SdfGrid() = default;
+    // Creates a lattice covering the given bounds, padded by the band
+    SdfGrid(const Vector3f& bbMin, const Vector3f& bbMax, float cellSize, int band = 2);
+
+    // Flat index of a lattice point
+    size_t index(int x, int y, int z) const
+    {
+        return (size_t)x + (size_t)this->dims.x() * ((size_t)y + (size_t)this->dims.y() * z);
+    }
+    // Position of a lattice point
+    Vector3f point(int x, int y, int z) const
+    {
+        return this->origin + Vector3f(x, y, z) * this->cellSize;
+    }
+
+    /**
+     * @brief Samples the signed distance to a closed triangle mesh: unsigned distances are
+     *        computed per triangle in a narrow band, signs come from ray parity along x rows
+     *
+     * @param vertices mesh vertices
+     * @param triangles mesh triangles
+     */
+    void rasterize(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles
+    );
+    // Combines another grid on the same lattice into this one (max, min or max with negation)
+    void combine(const SdfGrid& other, Op op);
+    // Extracts the zero level set by marching over lattice cells
+    csg::Geometry extract() const;
+};
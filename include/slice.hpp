@@ -0,0 +1,43 @@
+// Constant-lightness cross sections of Lab surfaces
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+
+/**
+ * @brief Cuts a closed Lab triangle mesh with planes of constant L*. Triangles are sorted into
+ *        bins by the L* range they span, so a slice only visits the bin holding its lightness
+ *        instead of every triangle.
+ */
+class LightnessSlicer
+{
+   public:
+    // Closed loop in the a*b* plane, the first point is not repeated at the end
+    using Polygon = std::vector<Vector2f>;
+
+   private:
+    float lo = 0.0f;
+    float binWidth = 1.0f;
+    // Triangles overlapping each bin, bin i holds binTriangles[binStarts[i]..binStarts[i + 1])
+    std::vector<uint32_t> binStarts;
+    std::vector<uint32_t> binTriangles;
+
+   public:
+    LightnessSlicer() = default;
+    // Indexes the triangles of a mesh whose vertices are (L*, a*, b*)
+    LightnessSlicer(const std::vector<Vector3f>& vertices, const std::vector<Vector3u>& triangles);
+
+    /**
+     * @brief Loops where the surface crosses L* = lightness, consistently oriented along the
+     *        mesh winding. Open chains, left by holes in the surface, are dropped.
+     *
+     * @param vertices the vertices the slicer was built with
+     * @param triangles the triangles the slicer was built with
+     * @param lightness L* of the cutting plane
+     */
+    std::vector<Polygon> slice(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        float lightness
+    ) const;
+};
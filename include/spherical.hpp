@@ -0,0 +1,71 @@
+// Gamut surfaces resampled onto one fixed icosphere topology, for per-vertex comparisons
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+#include <mesh.hpp>
+
+namespace spherical
+{
+    // Subdivisions of the icosahedron used for gamuts, 10242 vertices and 20480 triangles
+    constexpr uint32_t defaultSubdivisions = 5u;
+
+    // Unit directions of a subdivided icosahedron and the triangles connecting them
+    struct Icosphere
+    {
+        uint32_t subdivisions = 0u;
+        std::vector<Vector3f> directions;
+        std::vector<Vector3u> triangles;
+    };
+
+    // The icosphere with the given number of subdivisions, built once and shared
+    const Icosphere& icosphere(uint32_t subdivisions = defaultSubdivisions);
+    // GPU index buffer of an icosphere shared by every mesh drawn with its topology, alive as long
+    // as one of them is
+    std::shared_ptr<SharedIndexBuffer> indexBuffer(uint32_t subdivisions = defaultSubdivisions);
+
+    // A surface as its outermost distance from a center along every icosphere direction
+    struct Sampling
+    {
+        uint32_t subdivisions = 0u;
+        Vector3f center = Vector3f::Zero();
+        std::vector<float> radii;
+        // Surface point along every direction
+        std::vector<Vector3f> points;
+
+        bool empty() const { return this->points.empty(); }
+    };
+
+    /**
+     * @brief Casts a ray towards the center from outside the surface along every icosphere
+     *        direction, in parallel, and keeps the first hit. Directions where the surface
+     *        folds back over itself keep its outermost layer, directions that miss it get radius
+     *        zero.
+     *
+     * @param vertices surface vertices
+     * @param triangles surface triangles
+     * @param center point the rays converge on, GAMUT_CENTER for gamuts
+     * @param subdivisions icosphere to sample along
+     */
+    Sampling resample(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        const Vector3f& center,
+        uint32_t subdivisions = defaultSubdivisions
+    );
+
+    // Offset from every point of a to the matching point of b
+    std::vector<Vector3f> difference(const Sampling& a, const Sampling& b);
+    // Points moved from a towards b by t
+    std::vector<Vector3f> morph(const Sampling& a, const Sampling& b, float t);
+
+    // Spread of many samplings at every direction
+    struct Statistics
+    {
+        // Mean point
+        std::vector<Vector3f> mean;
+        // Root mean square distance from the mean point
+        std::vector<float> deviation;
+    };
+    Statistics statistics(const std::vector<const Sampling*>& samplings);
+}
@@ -0,0 +1,53 @@
+// Edge-based topology checks on index arrays, independent of CGAL
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+
+// Defects found in a triangle mesh, counted by checkTopology()
+struct TopologyReport
+{
+    // Edges used by a single triangle, the mesh has holes
+    size_t boundaryEdges = 0u;
+    // Edges shared by more than two triangles
+    size_t nonManifoldEdges = 0u;
+    // Edges whose two triangles traverse them in the same direction
+    size_t misorientedEdges = 0u;
+    // Vertices whose triangles form more than one fan, counted once per extra fan
+    size_t pinchedVertices = 0u;
+    // Vertices no valid triangle refers to
+    size_t isolatedVertices = 0u;
+    // Triangles with repeated or out of range indices, left out of the edge checks
+    size_t degenerateTriangles = 0u;
+
+    bool isClosed() const { return this->boundaryEdges == 0u; }
+    // True if the triangles can be turned into a halfedge mesh as they are
+    bool isPolygonMesh() const
+    {
+        return this->nonManifoldEdges == 0u && this->misorientedEdges == 0u &&
+               this->pinchedVertices == 0u && this->degenerateTriangles == 0u;
+    }
+    // True if nothing needs repair
+    bool ok() const { return this->isClosed() && this->isPolygonMesh() && !this->isolatedVertices; }
+
+    std::string _format() const
+    {
+        return fmt::format(
+            "{} boundary, {} non-manifold, {} misoriented edges, {} pinched, {} isolated vertices, "
+            "{} degenerate triangles",
+            this->boundaryEdges, this->nonManifoldEdges, this->misorientedEdges,
+            this->pinchedVertices, this->isolatedVertices, this->degenerateTriangles
+        );
+    }
+};
+
+/**
+ * @brief Counts topological defects in O(n): edges are keyed by their unordered vertex pair,
+ *        partitioned into shards by hash in parallel and counted in one hash map per shard, then
+ *        corners around each vertex are joined across manifold edges to find pinched vertices.
+ *
+ * @param vertexCount number of vertices the triangles index into
+ * @param triangles mesh triangles
+ * @return TopologyReport
+ */
+TopologyReport checkTopology(size_t vertexCount, const std::vector<Vector3u>& triangles);
@@ -71,6 +71,19 @@ template <std::unsigned_integral T> constexpr T cantor(T a, T b)
     return (a + b) * (a + b + T(1)) / T(2) + b;
 }
 
+// 64-bit FNV-1a of raw bytes. Unlike std::hash its values are specified, so they can be
+// persisted. Pass a previous result as basis to hash several buffers in sequence.
+constexpr uint64_t fnv1aBasis = 0xcbf29ce484222325ull;
+inline uint64_t fnv1a(const void* data, size_t size, uint64_t basis = fnv1aBasis)
+{
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t hash = basis;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
 // Cantor's pairing function (signed)
 template <std::signed_integral T> constexpr T cantor(T a, T b)
 {
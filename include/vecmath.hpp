@@ -168,6 +168,8 @@ Vector<float, _size> project(const Vector<float, _size>& a, const Vector<float,
 }
 // Returns normal vector from given triangle
 Vector3f normal(const Vector3f& v0, const Vector3f& v1, const Vector3f& v2);
+// Returns the point on the triangle closest to the given point
+Vector3f closestPoint(const Triangle& tri, const Vector3f& point);
 // Clamps the given vector between min and max
 Vector3f clamp(const Vector3f& v, const Vector3f& vmin, const Vector3f& vmax);
 // Creates a transformation matrix from given translation, rotation, and scale
@@ -0,0 +1,56 @@
+// Generalized winding numbers, for inside tests on surfaces with holes or other defects
+#pragma once
+
+#include <util.hpp>
+#include <vecmath.hpp>
+
+/**
+ * @brief Fast winding number evaluator after Barill et al. 2018. Triangles are grouped in a
+ *        binary tree whose nodes store the sum of their area-weighted normals as a dipole at
+ *        the area-weighted center. Far from a node the dipole stands in for its triangles,
+ *        near it the children or, at leaves, the exact solid angles are summed. The winding
+ *        number is 1 inside a closed surface and 0 outside, and degrades gracefully towards
+ *        0.5 across holes, so thresholding it is robust where ray parity is not.
+ */
+class WindingTree
+{
+   public:
+    // Triangles per leaf, evaluated exactly
+    static constexpr uint32_t leafSize = 8u;
+
+    // A node's dipole is used for points farther than beta times the node's radius from its
+    // center. Larger values are more accurate and slower, 2 keeps errors well under 0.5.
+    float beta = 2.0f;
+
+   private:
+    struct Node
+    {
+        // Area-weighted center and the distance from it to the farthest triangle corner
+        Vector3f center;
+        float radius;
+        // Sum of area-weighted normals
+        Vector3f dipole;
+        // First child for inner nodes, first slot in order for leaves
+        uint32_t first;
+        // Number of triangles, zero for inner nodes whose children are first and first + 1
+        uint32_t count;
+    };
+
+    std::vector<Node> nodes;
+    // Corners of the triangle in every leaf slot
+    std::vector<std::array<Vector3f, 3>> corners;
+    // 1 or -1, so surfaces wound either way give 1 inside
+    float orientation = 1.0f;
+
+   public:
+    WindingTree() = default;
+    WindingTree(const std::vector<Vector3f>& vertices, const std::vector<Vector3u>& triangles);
+
+    bool empty() const { return this->nodes.empty(); }
+    // Winding number of the surface around a point
+    float winding(const Vector3f& point) const;
+    // Winding numbers of many points, evaluated in parallel
+    std::vector<float> winding(const std::vector<Vector3f>& points) const;
+    // True if the winding number is above one half
+    bool contains(const Vector3f& point) const { return this->winding(point) > 0.5f; }
+};
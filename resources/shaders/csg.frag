@@ -0,0 +1,24 @@
+#version 450
+
+out vec4 fColor;
+
+uniform bool uComposite;
+uniform sampler2D uColor;
+uniform sampler2D uDepth;
+
+void main()
+{
+    if (!uComposite) {
+        // Pushes the depth to the far plane, discarding the candidate surface
+        fColor = vec4(0.0);
+        gl_FragDepth = 1.0;
+        return;
+    }
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    vec4 color = texelFetch(uColor, texel, 0);
+    if (color.a == 0.0) {
+        discard;
+    }
+    fColor = color;
+    gl_FragDepth = texelFetch(uDepth, texel, 0).r;
+}
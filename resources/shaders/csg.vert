@@ -0,0 +1,8 @@
+#version 450
+
+// Fullscreen triangle at the far plane, generated from the vertex index
+void main()
+{
+    vec2 pos = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2) * 2.0 - 1.0;
+    gl_Position = vec4(pos, 1.0, 1.0);
+}
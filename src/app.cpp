@@ -1,5 +1,41 @@
 #include <app.hpp>
+#include <csg.hpp>
+#include <sdf.hpp>
 #include <filesystem>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    // Distinct outline colors for overlays, cycled by gamut index
+    constexpr ImU32 palette[] = {
+        IM_COL32(230, 80, 80, 255),  IM_COL32(80, 200, 90, 255),  IM_COL32(90, 140, 240, 255),
+        IM_COL32(240, 200, 60, 255), IM_COL32(200, 90, 220, 255), IM_COL32(70, 210, 210, 255),
+        IM_COL32(240, 140, 60, 255), IM_COL32(220, 220, 220, 255),
+    };
+    constexpr size_t paletteSize = sizeof(palette) / sizeof(palette[0]);
+
+    // Overlay color of the gamut at an index, for text
+    ImVec4 paletteText(size_t index)
+    {
+        const ImU32 color = palette[index % paletteSize];
+        return ImVec4(
+            (color & 0xFF) / 255.0f, ((color >> 8) & 0xFF) / 255.0f,
+            ((color >> 16) & 0xFF) / 255.0f, 1.0f
+        );
+    }
+
+    // Lists the active gamuts in their overlay colors
+    void paletteLegend(const std::vector<std::shared_ptr<Gamut::GamutMesh>>& gamuts)
+    {
+        for (size_t i = 0; i < gamuts.size(); i++) {
+            if (gamuts[i]->isActive) {
+                ImGui::TextColored(paletteText(i), "%s", gamuts[i]->label.c_str());
+            }
+        }
+    }
+}
+
 App::App(Vector2f winSize)
 {
     glfwSwapInterval(1);
@@ -15,6 +51,7 @@ App::App(Vector2f winSize)
         Shader(GL_VERTEX_SHADER, fs::path("resources/shaders/mesh.vert")),
         Shader(GL_FRAGMENT_SHADER, fs::path("resources/shaders/mesh.frag")),
     });
+    stencilRenderer = std::make_unique<csg::StencilRenderer>();
 
     this->transparentGamut = -1;
     this->gamutOpacity = 0.5f;
@@ -81,7 +118,11 @@ void App::prepare()
 
 void App::update(float time, float delta)
 {
+    collectIntersections();
+    collectClassification();
+    trimSurfaceMeshes();
     updateGUI();
+    updateHeatmap();
 
     mouse.disabled = ImGui::GetIO().WantCaptureMouse;
 
@@ -122,7 +163,7 @@ void App::update(float time, float delta)
     program.setUniform("uTView", cam.getView());
     program.setUniform("uTProj", cam.getProj());
     program.setUniform("uOpacity", 1.0f);
-    program.setUniform("uExtent", 100.0f);
+    program.setUniform("uExtent", rgbExtent);
 }
 
 void App::draw(float time, float delta)
@@ -145,18 +186,26 @@ void App::draw(float time, float delta)
 
     program.setUniform("spaceInterp", this->spaceInterpolant);
     for (int i = 0; i < gamuts.size(); i++) {
-        if (i != transparentGamut) {
-            gamuts[i]->draw(gamuts[i]->isWireframe);
+        if (i != transparentGamut && gamuts[i]->isActive) {
+            gamutLevel(i).drawElements(gamuts[i]->isWireframe);
         }
     }
 
-    if (isValidIntersectionHash() && intersectionMeshes.contains(intersectionHash)) {
+    if (isValidIntersectionHash() && isStencilIntersection) {
+        std::vector<std::shared_ptr<Mesh>> meshes;
+        for (size_t i : intersectionGamuts()) {
+            meshes.push_back(gamuts[i]);
+        }
+        stencilRenderer->drawIntersection(meshes, program);
+    } else if (isValidIntersectionHash() && intersectionMeshes.contains(intersectionHash)) {
         intersectionMeshes[intersectionHash]->draw();
+    } else if (isValidIntersectionHash() && previewMeshes.contains(intersectionHash)) {
+        previewMeshes[intersectionHash]->draw();
     }
 
-    if (transparentGamut != -1 && gamuts[transparentGamut]) {
+    if (transparentGamut != -1 && gamuts[transparentGamut] && gamuts[transparentGamut]->isActive) {
         program.setUniform("uOpacity", gamutOpacity);
-        gamuts[transparentGamut]->draw(gamuts[transparentGamut]->isWireframe);
+        gamutLevel(transparentGamut).drawElements(gamuts[transparentGamut]->isWireframe);
     }
 
     ImGui::Render();
@@ -195,6 +244,14 @@ void App::updateGUI()
         }
         ImGui::EndCombo();
     }
+    int validationLevel = (int)validation;
+    if (ImGui::Combo("Validation", &validationLevel, "None\0Topology\0Full\0")) {
+        validation = (Gamut::Validation)validationLevel;
+    }
+    ImGui::SliderFloat("Remesh Edge", &remeshEdgeLength, 0.0f, 10.0f, "%.1f");
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Edge length in Lab units for gamuts loaded from now on, 0 to keep them");
+    }
     ImGui::Separator();
 
     int colorSpace = this->targetSpaceInterpolant;
@@ -215,11 +272,33 @@ void App::updateGUI()
     }
 
     ImGui::SliderFloat("Gamut Opacity", &gamutOpacity, 0.0f, 1.0f);
+    ImGui::Text(
+        "CGAL meshes: %.1f MB, AABB trees: %.1f MB", (double)surfaceMeshTotal / (1 << 20),
+        (double)aabbTreeTotal / (1 << 20)
+    );
+    ImGui::Checkbox("GPU Intersection", &isStencilIntersection);
+    ImGui::SameLine();
+    ImGui::Checkbox("Preview Intersections", &isPreviewBooleans);
+    ImGui::Checkbox("Resampled", &isSphericalView);
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Draws every gamut on one shared icosphere topology");
+    }
+    ImGui::SameLine();
+    ImGui::Checkbox("Level of Detail", &isLevelOfDetail);
+    if (isLevelOfDetail) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100.0f);
+        ImGui::SliderFloat("Tolerance (px)", &lodTolerance, 0.25f, 8.0f);
+    }
+    if (pendingIntersection.valid()) {
+        ImGui::SameLine();
+        ImGui::Text("(computing...)");
+    }
 
     ImGui::Separator();
 
     if (ImGui::BeginTable(
-            "Gamuts", 5,
+            "Gamuts", 7,
             ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_BordersInnerH | ImGuiTableFlags_RowBg
         )) {
         ImGui::TableSetupColumn("Visible", ImGuiTableColumnFlags_WidthFixed, 60.0f);
@@ -227,6 +306,8 @@ void App::updateGUI()
         ImGui::TableSetupColumn("Wireframe", ImGuiTableColumnFlags_WidthFixed, 60.0f);
         ImGui::TableSetupColumn("Transparent", ImGuiTableColumnFlags_WidthFixed, 80.0f);
         ImGui::TableSetupColumn("Intersect", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+        ImGui::TableSetupColumn("Volume", ImGuiTableColumnFlags_WidthFixed, 70.0f);
+        ImGui::TableSetupColumn("Area", ImGuiTableColumnFlags_WidthFixed, 70.0f);
         ImGui::TableHeadersRow();
         for (size_t i = 0; i < gamuts.size(); ++i) {
             ImGui::TableNextRow();
@@ -248,11 +329,109 @@ void App::updateGUI()
             ImGui::Checkbox(("##intersect" + std::to_string(i)).c_str(), &isIntersect);
             intersectionHash =
                 isIntersect ? intersectionHash | (1 << i) : intersectionHash & ~(1 << i);
-            generateIntersectionMesh();
+            if (!isStencilIntersection) {
+                generateIntersectionMesh();
+            }
+            const MeshIntegrals& integrals = gamuts[i]->integrals;
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1fK", integrals.volume / 1000.0);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip(
+                    "Centroid L=%.1f a=%.1f b=%.1f", integrals.centroid.x(), integrals.centroid.y(),
+                    integrals.centroid.z()
+                );
+            }
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1fK", integrals.area / 1000.0);
         }
         ImGui::EndTable();
     }
+    ImGui::Checkbox("Hover Readout", &isHoverReadout);
+    ImGui::SameLine();
+    ImGui::Checkbox("Lightness Slice", &isSliceView);
+    ImGui::SameLine();
+    ImGui::Checkbox("Hue Leaf", &isHueView);
+    ImGui::Checkbox("Chromaticity", &isChromaticityView);
+    // Distance colors replace the RGB coordinates the morph reads, keep them to Lab space
+    const bool isLabSpace = this->targetSpaceInterpolant == 0.0f && this->startTime < 0.0f;
+    if (!isLabSpace) {
+        ImGui::BeginDisabled();
+    }
+    ImGui::SetNextItemWidth(200.0f);
+    const bool hasHeatmap = heatmapTarget >= 0 && heatmapTarget < (int)gamuts.size();
+    const char* heatmapLabel = hasHeatmap ? gamuts[heatmapTarget]->label.c_str() : "(Lab colors)";
+    if (ImGui::BeginCombo("Distance To", heatmapLabel)) {
+        if (ImGui::Selectable("(Lab colors)", heatmapTarget < 0)) {
+            heatmapTarget = -1;
+        }
+        for (size_t i = 0; i < gamuts.size(); ++i) {
+            if (ImGui::Selectable(
+                    (gamuts[i]->label + "##heatmap" + std::to_string(i)).c_str(),
+                    heatmapTarget == (int)i
+                )) {
+                heatmapTarget = (int)i;
+            }
+        }
+        ImGui::EndCombo();
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("Colors other gamuts blue inside this one and red where they exceed it");
+    }
+    if (hasHeatmap) {
+        ImGui::SameLine();
+        ImGui::SetNextItemWidth(100.0f);
+        ImGui::SliderFloat("Range", &heatmapRange, 1.0f, 50.0f, "%.0f");
+    }
+    if (!isLabSpace) {
+        ImGui::EndDisabled();
+    }
+    ImGui::SetNextItemWidth(200.0f);
+    ImGui::InputText("##points", pointsPath, sizeof(pointsPath));
+    ImGui::SameLine();
+    const bool isClassifying = pendingClassification.valid();
+    if (isClassifying) {
+        ImGui::BeginDisabled();
+    }
+    if (ImGui::Button("Classify Points")) {
+        classifyPoints(pointsPath);
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip("CSV of L, a, b rows or raw .lab floats, checked against every gamut");
+    }
+    if (isClassifying) {
+        ImGui::EndDisabled();
+        ImGui::SameLine();
+        ImGui::Text("(classifying...)");
+    }
+    if (!pointsSummary.empty()) {
+        ImGui::Text("%s", pointsSummary.c_str());
+    }
     ImGui::End();
+    if (isSliceView) {
+        drawSlicePanel();
+    }
+    if (isHueView) {
+        drawHuePanel();
+        // Cusps are in Lab, the overlay would not follow the surface into RGB space
+        if (isCuspOverlay && spaceInterpolant == 0.0f && startTime < 0.0f) {
+            drawCuspLines();
+        }
+    }
+    if (isChromaticityView) {
+        drawChromaticityPanel();
+    }
+
+    // The surface moves while the color space animates, wait until it settles
+    if (isHoverReadout && !ImGui::GetIO().WantCaptureMouse && startTime < 0.0f) {
+        if (const std::optional<Pick> pick = pickGamut(mouse.pos)) {
+            const Vector3f rgb = Gamut::LABtoRGB(pick->lab) * 255.0f;
+            ImGui::BeginTooltip();
+            ImGui::Text("%s", gamuts[pick->gamut]->label.c_str());
+            ImGui::Text("L %.1f  a %.1f  b %.1f", pick->lab.x(), pick->lab.y(), pick->lab.z());
+            ImGui::Text("R %.0f  G %.0f  B %.0f", rgb.x(), rgb.y(), rgb.z());
+            ImGui::EndTooltip();
+        }
+    }
 }
 
 void App::event(const GLEQevent& event)
@@ -299,9 +478,39 @@ void App::onMouseButton(int button, bool pressed)
 
 void App::loadGamutMesh(const fs::path& filepath)
 {
-    gamuts.push_back(std::make_shared<Gamut::GamutMesh>(filepath.string(), program));
-    gamuts.back()->label = filepath.stem().string();
-    gamuts.back()->transform.rotate(AngleAxisf(pi / 2.0f, Vector3f::UnitZ()));
+    gamuts.push_back(readGamutMesh(filepath));
+}
+
+std::shared_ptr<Gamut::GamutMesh> App::readGamutMesh(const fs::path& filepath)
+{
+    auto gamut = std::make_shared<Gamut::GamutMesh>(
+        filepath.string(), program, validation, remeshEdgeLength
+    );
+    gamut->label = filepath.stem().string();
+    gamut->transform.rotate(AngleAxisf(pi / 2.0f, Vector3f::UnitZ()));
+    // Set once here, background intersections copy levels while the main thread draws them
+    for (const std::shared_ptr<Mesh>& level : gamut->levels) {
+        level->transform = gamut->transform;
+    }
+    return gamut;
+}
+
+void App::loadProfiles(const fs::path& directory)
+{
+    std::vector<fs::path> paths;
+    for (const auto& entry : fs::directory_iterator(directory)) {
+        if (entry.path().extension() == ".gam" && !importedGamuts.contains(entry.path())) {
+            importedGamuts.insert(entry.path());
+            paths.push_back(entry.path());
+        }
+    }
+    // Parsing, remeshing and simplification are independent per gamut
+    std::vector<std::shared_ptr<Gamut::GamutMesh>> loaded(paths.size());
+    std::transform(
+        std::execution::par, paths.begin(), paths.end(), loaded.begin(),
+        [this](const fs::path& path) { return readGamutMesh(path); }
+    );
+    gamuts.insert(gamuts.end(), loaded.begin(), loaded.end());
 }
 
 void App::switchSpace()
@@ -310,36 +519,61 @@ void App::switchSpace()
     this->isAnimateSpace = true;
 }
 
-void App::intersectTwoMeshes(
-    std::shared_ptr<Mesh> a,
-    std::shared_ptr<Mesh> b,
-    uint8_t hash
-)
+std::shared_ptr<Mesh> App::intersectTwoMeshes(std::shared_ptr<Mesh> a, std::shared_ptr<Mesh> b)
 {
-    SurfaceMesh mesh;
-    bool result = PMP::corefine_and_compute_union(a->surfaceMesh, b->surfaceMesh, mesh);
+    const csg::Relation relation = csg::classify(*a, *b);
+    switch (relation) {
+        case csg::Relation::disjoint:
+            $debug("{} and {} are disjoint", a->label, b->label);
+            return std::make_shared<Mesh>(
+                std::vector<Vector3f>{}, std::vector<Vector3u>{}, std::vector<Vector3f>{}, program
+            );
+        case csg::Relation::aInsideB:
+        case csg::Relation::bInsideA: {
+            const std::shared_ptr<Mesh>& inner = relation == csg::Relation::aInsideB ? a : b;
+            $debug("{} is contained in {}", inner->label, (inner == a ? b : a)->label);
+            // Colored from Lab rather than copied, the main thread may be drawing a heatmap into
+            // the colors of the gamut
+            std::shared_ptr<Mesh> mesh = this->labMesh({ inner->vertices, inner->triangles });
+            mesh->convex = inner->convex;
+            return mesh;
+        }
+        case csg::Relation::overlapping:
+            break;
+    }
+
+    std::optional<csg::Geometry> result = csg::intersect(*a, *b);
     if (!result) {
         $warn("Intersection failed");
-        return;
+        return nullptr;
     }
-    std::vector<Vector3f> vertices;
-    std::vector<Vector3f> colors;
-    for (const auto& v : mesh.vertices()) {
-        Point3 p = mesh.point(v);
-        vertices.push_back({ (float)p[0], (float)p[1], (float)p[2] });
-        colors.push_back(Gamut::LABtoRGB(vertices.back()));
+    std::shared_ptr<Mesh> mesh = this->labMesh(*result);
+    // The intersection of convex sets is convex
+    if (a->isConvex() && b->isConvex()) {
+        mesh->convex = true;
     }
-    std::vector<Vector3u> faces;
-    for (const auto& f : mesh.faces()) {
-        Vector3u face;
-        uint32_t i = 0;
-        for (auto v : mesh.vertices_around_face(mesh.halfedge(f))) {
-            face[i++] = v.idx();
+    return mesh;
+}
+
+std::shared_ptr<Mesh> App::labMesh(const csg::Geometry& geom)
+{
+    std::vector<Vector3f> colors(geom.vertices.size());
+    std::transform(
+        std::execution::par, geom.vertices.begin(), geom.vertices.end(), colors.begin(),
+        [](const Vector3f& v) { return Gamut::LABtoRGB(v); }
+    );
+    return std::make_shared<Mesh>(geom.vertices, geom.triangles, colors, program);
+}
+
+std::vector<size_t> App::intersectionGamuts() const
+{
+    std::vector<size_t> activeGamuts;
+    for (size_t i = 0; i < gamuts.size(); ++i) {
+        if (intersectionHash & (1 << i)) {
+            activeGamuts.push_back(i);
         }
-        faces.push_back(face);
     }
-    intersectionMeshes[hash] = std::make_shared<Mesh>(vertices, faces, colors, program);
-    intersectionMeshes[hash]->transform = a->transform;
+    return activeGamuts;
 }
 
 void App::generateIntersectionMesh()
@@ -348,26 +582,563 @@ void App::generateIntersectionMesh()
     if (!isValidIntersectionHash() || gamuts.size() == 0) {
         return;
     }
-    if (intersectionMeshes.contains(intersectionHash)) {
+    if (intersectionMeshes.contains(intersectionHash) ||
+        failedIntersections.contains(intersectionHash)) {
         return;
     }
-    std::vector<size_t> activeGamuts;
-    for (size_t i = 0; i < gamuts.size(); ++i) {
-        if (intersectionHash & (1 << i)) {
-            activeGamuts.push_back(i);
-        }
+    // Only one exact intersection runs at a time, this is called again every frame
+    if (pendingIntersection.valid()) {
+        return;
     }
-    if(activeGamuts.size() == 3) {
-        $info("Intersecting 3 gamuts");
+    if (isPreviewBooleans && !previewMeshes.contains(intersectionHash)) {
+        generatePreviewMesh();
     }
-    uint8_t currentHash = 0, prevHash = (1 << activeGamuts[0]);
+
+    std::vector<size_t> activeGamuts = intersectionGamuts();
+    // Continue from the longest chain of intersections that is already cached
+    uint8_t prevHash = (1 << activeGamuts[0]);
     std::shared_ptr<Mesh> prevMesh = gamuts[activeGamuts[0]];
-    for (size_t i = 0; i < activeGamuts.size()-1; ++i) {
-        currentHash = prevHash | (1 << activeGamuts[i + 1]);
-        if (!intersectionMeshes.contains(currentHash)) {
-            intersectTwoMeshes(prevMesh, gamuts[activeGamuts[i + 1]], currentHash);
+    size_t next = 1;
+    while (next < activeGamuts.size() &&
+           intersectionMeshes.contains(prevHash | (1 << activeGamuts[next]))) {
+        prevHash |= (1 << activeGamuts[next]);
+        prevMesh = intersectionMeshes[prevHash];
+        next++;
+    }
+    std::vector<std::pair<uint8_t, std::shared_ptr<Mesh>>> steps;
+    for (; next < activeGamuts.size(); next++) {
+        prevHash |= (1 << activeGamuts[next]);
+        steps.emplace_back(prevHash, gamuts[activeGamuts[next]]);
+    }
+
+    // Coarse levels of all selected gamuts give a quick first result while the exact one runs
+    std::vector<std::shared_ptr<Mesh>> coarse;
+    if (isPreviewBooleans) {
+        for (size_t i : activeGamuts) {
+            if (gamuts[i]->levels.empty()) {
+                coarse.clear();
+                break;
+            }
+            coarse.push_back(gamuts[i]->levels.back());
+        }
+    }
+
+    // The worker classifies shared gamut meshes, fill their convexity caches here so it only
+    // reads them. Surface meshes and AABB trees are built under the meshes' own locks.
+    prevMesh->isConvex();
+    for (const auto& [stepHash, other] : steps) {
+        other->isConvex();
+    }
+    for (const std::shared_ptr<Mesh>& level : coarse) {
+        level->isConvex();
+    }
+
+    // The worker never touches transforms, its results get this one when they are collected
+    pendingTransform = gamuts[activeGamuts[0]]->transform;
+    const uint8_t hash = intersectionHash;
+    pendingIntersection = std::async(std::launch::async, [this, prevMesh, steps, coarse, hash]() {
+        if (!coarse.empty()) {
+            StopWatch timer("Coarse intersection");
+            std::shared_ptr<Mesh> mesh = coarse[0];
+            for (size_t i = 1; mesh && i < coarse.size(); i++) {
+                mesh = intersectTwoMeshes(mesh, coarse[i]);
+            }
+            if (mesh) {
+                std::scoped_lock lock(coarseIntersectionsMutex);
+                coarseIntersections.emplace_back(hash, mesh);
+            }
+        }
+
+        StopWatch timer("Exact intersection");
+        std::vector<std::pair<uint8_t, std::shared_ptr<Mesh>>> results;
+        std::shared_ptr<Mesh> mesh = prevMesh;
+        for (const auto& [hash, other] : steps) {
+            mesh = intersectTwoMeshes(mesh, other);
+            results.emplace_back(hash, mesh);
+            if (!mesh) {
+                break;
+            }
+        }
+        return results;
+    });
+}
+
+void App::generatePreviewMesh()
+{
+    StopWatch timer("Intersection preview");
+    std::vector<size_t> activeGamuts = intersectionGamuts();
+
+    // Lattice over the region shared by all selected gamuts
+    Vector3f bbMin = gamuts[activeGamuts[0]]->bbMin;
+    Vector3f bbMax = gamuts[activeGamuts[0]]->bbMax;
+    for (size_t i : activeGamuts) {
+        bbMin = bbMin.cwiseMax(gamuts[i]->bbMin);
+        bbMax = bbMax.cwiseMin(gamuts[i]->bbMax);
+    }
+    if ((bbMin.array() > bbMax.array()).any()) {
+        previewMeshes[intersectionHash] = labMesh({});
+        return;
+    }
+    const float cellSize = (bbMax - bbMin).maxCoeff() / (float)previewResolution;
+
+    std::vector<SdfGrid> grids(activeGamuts.size(), SdfGrid(bbMin, bbMax, cellSize));
+    std::vector<size_t> gridIndices(grids.size());
+    std::iota(gridIndices.begin(), gridIndices.end(), 0u);
+    std::for_each(std::execution::par, gridIndices.begin(), gridIndices.end(), [&](size_t i) {
+        grids[i].rasterize(gamuts[activeGamuts[i]]->vertices, gamuts[activeGamuts[i]]->triangles);
+    });
+    for (size_t i = 1; i < grids.size(); i++) {
+        grids[0].combine(grids[i], SdfGrid::Op::intersect);
+    }
+
+    std::shared_ptr<Mesh> mesh = labMesh(grids[0].extract());
+    mesh->transform = gamuts[activeGamuts[0]]->transform;
+    previewMeshes[intersectionHash] = mesh;
+}
+
+void App::collectIntersections()
+{
+    {
+        std::scoped_lock lock(coarseIntersectionsMutex);
+        for (auto& [hash, mesh] : coarseIntersections) {
+            mesh->transform = pendingTransform;
+            previewMeshes[hash] = mesh;
+        }
+        coarseIntersections.clear();
+    }
+    using namespace std::chrono_literals;
+    if (!pendingIntersection.valid() ||
+        pendingIntersection.wait_for(0s) != std::future_status::ready) {
+        return;
+    }
+    for (auto& [hash, mesh] : pendingIntersection.get()) {
+        if (mesh) {
+            mesh->transform = pendingTransform;
+            intersectionMeshes[hash] = mesh;
+        } else {
+            failedIntersections.insert(hash);
         }
-        prevMesh = intersectionMeshes[currentHash];
-        prevHash = currentHash;
+        previewMeshes.erase(hash);
+    }
+}
+
+void App::updateSlices()
+{
+    if (sliceLightness == slicedLightness && sliceLoops.size() == gamuts.size()) {
+        return;
     }
+    sliceLoops.resize(gamuts.size());
+    std::vector<size_t> indices(gamuts.size());
+    std::iota(indices.begin(), indices.end(), 0u);
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+        const Gamut::GamutMesh& gamut = *gamuts[i];
+        sliceLoops[i] = gamut.slicer.slice(gamut.vertices, gamut.triangles, sliceLightness);
+    });
+    slicedLightness = sliceLightness;
+}
+
+void App::updateHeatmap()
+{
+    const bool isLabSpace = this->targetSpaceInterpolant == 0.0f && this->startTime < 0.0f &&
+                            this->spaceInterpolant == 0.0f;
+    const int target = isLabSpace && heatmapTarget < (int)gamuts.size() ? heatmapTarget : -1;
+    if (target == coloredTarget && (target < 0 || heatmapRange == coloredRange) &&
+        gamuts.size() == coloredCount) {
+        return;
+    }
+    // Background intersections may be reading the gamuts, the recoloring waits for them
+    if (pendingIntersection.valid()) {
+        return;
+    }
+    for (size_t i = 0; i < gamuts.size(); i++) {
+        if (target < 0 || (int)i == target) {
+            gamuts[i]->resetColors();
+        } else {
+            gamuts[i]->colorByDistance(*gamuts[target], heatmapRange);
+        }
+    }
+    coloredTarget = target;
+    coloredRange = heatmapRange;
+    coloredCount = gamuts.size();
+}
+
+void App::drawSlicePanel()
+{
+    // a* and b* shown from -range to range
+    constexpr float range = 128.0f;
+    constexpr float size = 320.0f;
+
+    ImGui::SetNextWindowPos({ cam.viewSize.x() - size - 24.0f, 4.0f }, ImGuiCond_FirstUseEver);
+    if (!ImGui::Begin("Lightness Slice", &isSliceView, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+    ImGui::SliderFloat("L*", &sliceLightness, 0.0f, 100.0f, "%.1f");
+    updateSlices();
+
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const auto toScreen = [&](const Vector2f& ab) {
+        return ImVec2(
+            origin.x + (ab.x() + range) / (2.0f * range) * size,
+            origin.y + (range - ab.y()) / (2.0f * range) * size
+        );
+    };
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const ImVec2 corner(origin.x + size, origin.y + size);
+    const ImU32 axisColor = IM_COL32(90, 90, 90, 255);
+    drawList->AddRectFilled(origin, corner, IM_COL32(20, 20, 20, 255));
+    drawList->AddLine(toScreen({ -range, 0.0f }), toScreen({ range, 0.0f }), axisColor);
+    drawList->AddLine(toScreen({ 0.0f, -range }), toScreen({ 0.0f, range }), axisColor);
+    drawList->PushClipRect(origin, corner, true);
+    std::vector<ImVec2> points;
+    for (size_t i = 0; i < gamuts.size(); i++) {
+        if (!gamuts[i]->isActive) {
+            continue;
+        }
+        for (const LightnessSlicer::Polygon& loop : sliceLoops[i]) {
+            points.resize(loop.size());
+            std::transform(loop.begin(), loop.end(), points.begin(), toScreen);
+            drawList->AddPolyline(
+                points.data(), (int)points.size(), palette[i % paletteSize], ImDrawFlags_Closed,
+                1.5f
+            );
+        }
+    }
+    drawList->PopClipRect();
+    ImGui::Dummy({ size, size });
+    paletteLegend(gamuts);
+    ImGui::End();
+}
+
+void App::updateLeaves()
+{
+    if (cuspLines.size() != gamuts.size()) {
+        const size_t known = cuspLines.size();
+        cuspLines.resize(gamuts.size());
+        std::vector<size_t> indices(gamuts.size() - known);
+        std::iota(indices.begin(), indices.end(), known);
+        std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+            const Gamut::GamutMesh& gamut = *gamuts[i];
+            cuspLines[i] = gamut.hueSlicer.cusps(gamut.vertices, gamut.triangles);
+        });
+        leafedHue = -1.0f;
+    }
+    if (leafHue == leafedHue) {
+        return;
+    }
+    leafOutlines.resize(gamuts.size());
+    const float hue = leafHue * tau / 360.0f;
+    std::vector<size_t> indices(gamuts.size());
+    std::iota(indices.begin(), indices.end(), 0u);
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+        const Gamut::GamutMesh& gamut = *gamuts[i];
+        leafOutlines[i] = gamut.hueSlicer.leaf(gamut.vertices, gamut.triangles, hue);
+    });
+    leafedHue = leafHue;
+}
+
+void App::drawHuePanel()
+{
+    // Chroma shown up to range, lightness from 0 to 100
+    constexpr float range = 150.0f;
+    constexpr float width = 360.0f, height = 240.0f;
+
+    ImGui::SetNextWindowPos(
+        { cam.viewSize.x() - width - 24.0f, cam.viewSize.y() - height - 160.0f },
+        ImGuiCond_FirstUseEver
+    );
+    if (!ImGui::Begin("Hue Leaf", &isHueView, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+    ImGui::SliderFloat("Hue", &leafHue, 0.0f, 359.0f, "%.0f deg");
+    updateLeaves();
+
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const auto toScreen = [&](const Vector2f& cl) {
+        return ImVec2(
+            origin.x + cl.x() / range * width, origin.y + (100.0f - cl.y()) / 100.0f * height
+        );
+    };
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const ImVec2 corner(origin.x + width, origin.y + height);
+    drawList->AddRectFilled(origin, corner, IM_COL32(20, 20, 20, 255));
+    drawList->AddLine(
+        toScreen({ 0.0f, 50.0f }), toScreen({ range, 50.0f }), IM_COL32(90, 90, 90, 255)
+    );
+    drawList->PushClipRect(origin, corner, true);
+    std::vector<ImVec2> points;
+    const size_t cuspIndex = (size_t)std::lround(leafHue) % 360u;
+    for (size_t i = 0; i < gamuts.size(); i++) {
+        if (!gamuts[i]->isActive) {
+            continue;
+        }
+        for (const HueSlicer::Polygon& outline : leafOutlines[i]) {
+            points.resize(outline.size());
+            std::transform(outline.begin(), outline.end(), points.begin(), toScreen);
+            drawList->AddPolyline(
+                points.data(), (int)points.size(), palette[i % paletteSize], ImDrawFlags_Closed,
+                1.5f
+            );
+        }
+        const Vector3f& cusp = cuspLines[i][cuspIndex];
+        drawList->AddCircleFilled(
+            toScreen({ cusp.tail<2>().norm(), cusp.x() }), 3.5f, palette[i % paletteSize]
+        );
+    }
+    drawList->PopClipRect();
+    ImGui::Dummy({ width, height });
+    ImGui::Checkbox("Cusp Lines", &isCuspOverlay);
+    paletteLegend(gamuts);
+    ImGui::End();
+}
+
+void App::drawCuspLines()
+{
+    ImDrawList* drawList = ImGui::GetBackgroundDrawList();
+    std::vector<ImVec2> points;
+    for (size_t i = 0; i < gamuts.size() && i < cuspLines.size(); i++) {
+        if (!gamuts[i]->isActive) {
+            continue;
+        }
+        points.resize(cuspLines[i].size());
+        std::transform(
+            cuspLines[i].begin(), cuspLines[i].end(), points.begin(),
+            [&](const Vector3f& lab) {
+                const Vector2f p = cam.worldToScreen(gamuts[i]->transform * lab);
+                return ImVec2(p.x(), p.y());
+            }
+        );
+        drawList->AddPolyline(
+            points.data(), (int)points.size(), palette[i % paletteSize], ImDrawFlags_Closed, 2.0f
+        );
+    }
+}
+
+void App::classifyPoints(const fs::path& path)
+{
+    if (!fs::exists(path)) {
+        $warn("{} does not exist", path.string());
+        pointsSummary = fmt::format("{} not found", path.string());
+        return;
+    }
+    // The worker holds its own references, so gamuts loaded or removed meanwhile do not reach it
+    pendingClassification = std::async(std::launch::async, [path, gamuts = gamuts]() {
+        const std::vector<Vector3f> labs = points::read(path);
+        const points::Classification result = points::classify(labs, gamuts);
+        fs::path output = path;
+        output.replace_filename(path.stem().string() + "_classified.csv");
+        points::writeCsv(output, labs, gamuts, result);
+
+        const uint64_t all = result.gamutCount == 64u ? ~0ull : (1ull << result.gamutCount) - 1u;
+        const size_t inAll = std::count(result.masks.begin(), result.masks.end(), all);
+        const size_t inNone = std::count(result.masks.begin(), result.masks.end(), 0u);
+        return fmt::format("{} points: {} in every gamut, {} in none", labs.size(), inAll, inNone);
+    });
+}
+
+void App::collectClassification()
+{
+    using namespace std::chrono_literals;
+    if (!pendingClassification.valid() ||
+        pendingClassification.wait_for(0s) != std::future_status::ready) {
+        return;
+    }
+    pointsSummary = pendingClassification.get();
+}
+
+std::optional<App::Pick> App::pickGamut(const Vector2f& screenPoint)
+{
+    const Ray ray = cam.getRay(screenPoint);
+    std::optional<Pick> pick;
+    float nearest = std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < gamuts.size(); i++) {
+        if (!gamuts[i]->isActive) {
+            continue;
+        }
+        const std::optional<Bvh::Hit> hit = gamuts[i]->pick(ray, spaceInterpolant, rgbExtent);
+        if (hit && hit->distance < nearest) {
+            nearest = hit->distance;
+            pick = Pick{ i, gamuts[i]->labAt(*hit) };
+        }
+    }
+    return pick;
+}
+
+Mesh& App::gamutLevel(size_t i)
+{
+    Gamut::GamutMesh& gamut = *gamuts[i];
+    if (isSphericalView && gamut.resampled) {
+        gamut.resampled->transform = gamut.transform;
+        return *gamut.resampled;
+    }
+    if (!isLevelOfDetail) {
+        return gamut;
+    }
+    const Vector3f center = gamut.transform * ((gamut.bbMin + gamut.bbMax) / 2.0f);
+    return gamut.levelFor(lod::pixelsPerUnit(cam, center), lodTolerance);
+}
+
+std::vector<std::shared_ptr<Mesh>> App::allMeshes() const
+{
+    std::vector<std::shared_ptr<Mesh>> meshes(gamuts.begin(), gamuts.end());
+    for (const auto& gamut : gamuts) {
+        meshes.insert(meshes.end(), gamut->levels.begin(), gamut->levels.end());
+    }
+    for (const auto& [hash, mesh] : intersectionMeshes) {
+        meshes.push_back(mesh);
+    }
+    return meshes;
+}
+
+void App::trimSurfaceMeshes()
+{
+    // The background intersection may be using any of them
+    if (pendingIntersection.valid()) {
+        return;
+    }
+    std::vector<std::shared_ptr<Mesh>> meshes = allMeshes();
+    size_t total = 0u;
+    aabbTreeTotal = 0u;
+    for (const auto& mesh : meshes) {
+        total += mesh->surfaceMeshBytes() + mesh->aabbTreeBytes();
+        aabbTreeTotal += mesh->aabbTreeBytes();
+    }
+    surfaceMeshTotal = total - aabbTreeTotal;
+    if (total <= surfaceMeshBudget) {
+        return;
+    }
+    std::sort(meshes.begin(), meshes.end(), [](const auto& a, const auto& b) {
+        return a->surfaceMeshLastUsed() < b->surfaceMeshLastUsed();
+    });
+    for (const auto& mesh : meshes) {
+        if (total <= surfaceMeshBudget) {
+            break;
+        }
+        if (mesh->hasSurfaceMesh()) {
+            const size_t treeBytes = mesh->aabbTreeBytes();
+            total -= mesh->surfaceMeshBytes() + treeBytes;
+            aabbTreeTotal -= treeBytes;
+            mesh->releaseSurfaceMesh();
+            $debug("Released surface mesh of {}", mesh->label);
+        }
+    }
+    surfaceMeshTotal = total - aabbTreeTotal;
+}
+
+void App::updateFootprints()
+{
+    if (footprints.size() != gamuts.size()) {
+        const size_t known = footprints.size();
+        footprints.resize(gamuts.size());
+        std::vector<size_t> indices(gamuts.size() - known);
+        std::iota(indices.begin(), indices.end(), known);
+        std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+            for (const chromaticity::Diagram d : { chromaticity::Diagram::xy,
+                                                   chromaticity::Diagram::uv }) {
+                footprints[i][(size_t)d] = chromaticity::project(gamuts[i]->vertices, d);
+            }
+        });
+        footprintSelection.clear();
+    }
+    std::vector<bool> selection(gamuts.size());
+    std::transform(gamuts.begin(), gamuts.end(), selection.begin(), [](const auto& gamut) {
+        return gamut->isActive;
+    });
+    if (selection == footprintSelection && diagram == footprintDiagram) {
+        return;
+    }
+
+    // Hulls are kept per gamut, a selection change only merges and intersects them
+    std::vector<const chromaticity::Footprint*> selected;
+    for (size_t i = 0; i < gamuts.size(); i++) {
+        if (selection[i]) {
+            selected.push_back(&footprints[i][(size_t)diagram]);
+        }
+    }
+    overlapAreas.assign(selected.size(), 0.0);
+    std::vector<size_t> indices(selected.size());
+    std::iota(indices.begin(), indices.end(), 0u);
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+        overlapAreas[i] = chromaticity::overlapArea(*selected.front(), *selected[i]);
+    });
+    selectionFootprint = chromaticity::combine(selected);
+    footprintSelection = std::move(selection);
+    footprintDiagram = diagram;
+}
+
+void App::drawChromaticityPanel()
+{
+    constexpr float size = 320.0f;
+
+    ImGui::SetNextWindowPos(
+        { cam.viewSize.x() - 2.0f * size - 48.0f, 4.0f }, ImGuiCond_FirstUseEver
+    );
+    if (!ImGui::Begin("Chromaticity", &isChromaticityView, ImGuiWindowFlags_AlwaysAutoResize)) {
+        ImGui::End();
+        return;
+    }
+    int selected = (int)diagram;
+    ImGui::RadioButton("xy", &selected, (int)chromaticity::Diagram::xy);
+    ImGui::SameLine();
+    ImGui::RadioButton("u'v'", &selected, (int)chromaticity::Diagram::uv);
+    diagram = (chromaticity::Diagram)selected;
+    updateFootprints();
+
+    // x and y shown from 0 to 0.8 for xy, u' and v' from 0 to 0.65 for u'v'
+    const float range = diagram == chromaticity::Diagram::xy ? 0.8f : 0.65f;
+    const ImVec2 origin = ImGui::GetCursorScreenPos();
+    const auto toScreen = [&](const Vector2f& p) {
+        return ImVec2(origin.x + p.x() / range * size, origin.y + (1.0f - p.y() / range) * size);
+    };
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const ImVec2 corner(origin.x + size, origin.y + size);
+    drawList->AddRectFilled(origin, corner, IM_COL32(20, 20, 20, 255));
+    drawList->PushClipRect(origin, corner, true);
+    std::vector<ImVec2> points;
+    const auto drawLoop = [&](const polygon::Loop& loop, ImU32 color, float thickness) {
+        points.resize(loop.size());
+        std::transform(loop.begin(), loop.end(), points.begin(), toScreen);
+        drawList->AddPolyline(
+            points.data(), (int)points.size(), color, ImDrawFlags_Closed, thickness
+        );
+    };
+    drawLoop(chromaticity::locus(diagram), IM_COL32(120, 120, 120, 255), 1.0f);
+    for (size_t i = 0; i < gamuts.size(); i++) {
+        if (gamuts[i]->isActive) {
+            drawLoop(footprints[i][(size_t)diagram].hull, palette[i % paletteSize], 1.5f);
+        }
+    }
+    drawList->PopClipRect();
+    ImGui::Dummy({ size, size });
+
+    // Areas, and overlaps relative to the first active gamut
+    if (ImGui::BeginTable("Footprints", 3, ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_RowBg)) {
+        ImGui::TableSetupColumn("Gamut");
+        ImGui::TableSetupColumn("Area");
+        ImGui::TableSetupColumn("Overlap");
+        ImGui::TableHeadersRow();
+        size_t k = 0;
+        for (size_t i = 0; i < gamuts.size(); i++) {
+            if (!gamuts[i]->isActive) {
+                continue;
+            }
+            const double area = footprints[i][(size_t)diagram].area;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextColored(paletteText(i), "%s", gamuts[i]->label.c_str());
+            ImGui::TableNextColumn();
+            ImGui::Text("%.4f", area);
+            ImGui::TableNextColumn();
+            ImGui::Text(
+                "%.4f (%.0f%%)", overlapAreas[k], area > 0.0 ? 100.0 * overlapAreas[k] / area : 0.0
+            );
+            k++;
+        }
+        ImGui::EndTable();
+    }
+    if (!selectionFootprint.empty()) {
+        ImGui::Text("Combined: %.4f", selectionFootprint.area);
+    }
+    ImGui::End();
 }
@@ -0,0 +1,111 @@
+#include <benchmark.hpp>
+#include <csg.hpp>
+#include <integrals.hpp>
+#include <remesh.hpp>
+
+void bench::run(App& app)
+{
+    app.loadProfiles("resources/profiles");
+    bench::intersections(app);
+    bench::integrals(app);
+    bench::remeshing(app);
+}
+
+void bench::intersections(App& app)
+{
+    for (size_t i = 0; i < app.gamuts.size(); i++) {
+        for (size_t j = i + 1; j < app.gamuts.size(); j++) {
+            Gamut::GamutMesh& a = *app.gamuts[i];
+            Gamut::GamutMesh& b = *app.gamuts[j];
+            const std::string pair = fmt::format("{} x {}", a.label, b.label);
+
+            StopWatch detectTimer(pair + " convexity detection");
+            const bool convex = a.isConvex() && b.isConvex();
+            detectTimer.stop(convex ? "(convex)" : "(not convex)");
+
+            size_t clipTime = 0u;
+            if (convex) {
+                StopWatch clipTimer(pair + " convex clipping");
+                const csg::Geometry clipped = csg::intersectConvex(a, b);
+                clipTime = clipTimer.elapsed();
+                clipTimer.stop(fmt::format("({} triangles)", clipped.triangles.size()));
+            }
+
+            StopWatch corefineTimer(pair + " corefinement");
+            const std::optional<csg::Geometry> corefined = csg::intersectCorefine(a, b);
+            const size_t corefineTime = corefineTimer.elapsed();
+            corefineTimer.stop(fmt::format(
+                "({} triangles)", corefined ? corefined->triangles.size() : size_t(0)
+            ));
+
+            if (convex) {
+                $info(
+                    "{}: convex clipping is {:.1f}x faster than corefinement", pair,
+                    (float)corefineTime / (float)std::max(clipTime, size_t(1))
+                );
+            }
+        }
+    }
+}
+
+void bench::integrals(App& app)
+{
+    for (const auto& gamut : app.gamuts) {
+        StopWatch timer(gamut->label + " integrals");
+        const MeshIntegrals result = integrate(gamut->vertices, gamut->triangles);
+        timer.stop(fmt::format(
+            "({} triangles, volume {:.0f}, area {:.0f})", gamut->triangles.size(), result.volume,
+            result.area
+        ));
+    }
+    if (app.gamuts.empty()) {
+        return;
+    }
+
+    const Gamut::GamutMesh& gamut = *app.gamuts.front();
+    std::vector<Vector3u> triangles;
+    while (triangles.size() < 4'000'000u) {
+        triangles.insert(triangles.end(), gamut.triangles.begin(), gamut.triangles.end());
+    }
+    StopWatch timer("Large mesh integrals");
+    const MeshIntegrals result = integrate(gamut.vertices, triangles);
+    timer.stop(fmt::format("({} triangles, volume {:.0f})", triangles.size(), result.volume));
+}
+
+void bench::remeshing(App& app, float edgeLength)
+{
+    std::vector<std::shared_ptr<Mesh>> remeshed;
+    for (const auto& gamut : app.gamuts) {
+        StopWatch timer(fmt::format("{} remeshing to {:.1f}", gamut->label, edgeLength));
+        const csg::Geometry geom = remesh::isotropic(gamut->vertices, gamut->triangles, edgeLength);
+        timer.stop(
+            fmt::format("({} -> {} triangles)", gamut->triangles.size(), geom.triangles.size())
+        );
+        remeshed.push_back(std::make_shared<Mesh>(
+            geom.vertices, geom.triangles, std::vector<Vector3f>(), app.program
+        ));
+        remeshed.back()->label = gamut->label + " remeshed";
+    }
+
+    for (size_t i = 0; i < app.gamuts.size(); i++) {
+        for (size_t j = i + 1; j < app.gamuts.size(); j++) {
+            const std::string pair =
+                fmt::format("{} x {}", app.gamuts[i]->label, app.gamuts[j]->label);
+            StopWatch originalTimer(pair + " corefinement as loaded");
+            const bool originalOk =
+                csg::intersectCorefine(*app.gamuts[i], *app.gamuts[j]).has_value();
+            const size_t originalTime = originalTimer.elapsed();
+            originalTimer.stop(originalOk ? "" : "(failed)");
+
+            StopWatch remeshedTimer(pair + " corefinement remeshed");
+            const bool remeshedOk = csg::intersectCorefine(*remeshed[i], *remeshed[j]).has_value();
+            const size_t remeshedTime = remeshedTimer.elapsed();
+            remeshedTimer.stop(remeshedOk ? "" : "(failed)");
+
+            $info(
+                "{}: remeshed corefinement takes {:.2f}x the time", pair,
+                (float)remeshedTime / (float)std::max(originalTime, size_t(1))
+            );
+        }
+    }
+}
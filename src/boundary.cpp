@@ -0,0 +1,310 @@
+#include <boundary.hpp>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    // Segments a triangle reaches and the radii it reaches them at
+    struct Footprint
+    {
+        int firstRow = 0;
+        int lastRow = -1;
+        int firstColumn = 0;
+        int columnCount = 0;
+        float rMin = 0.0f;
+        float rMax = 0.0f;
+    };
+
+    // Whether the ray from origin along direction crosses the triangle, from either side
+    bool crosses(
+        const Vector3f& origin,
+        const Vector3f& direction,
+        const Vector3f& a,
+        const Vector3f& b,
+        const Vector3f& c
+    )
+    {
+        const Vector3f e1 = b - a;
+        const Vector3f e2 = c - a;
+        const Vector3f p = direction.cross(e2);
+        const float det = e1.dot(p);
+        if (std::abs(det) <= 1e-12f) {
+            return false;
+        }
+        const Vector3f s = origin - a;
+        const float u = s.dot(p) / det;
+        const Vector3f q = s.cross(e1);
+        const float v = direction.dot(q) / det;
+        return u >= 0.0f && v >= 0.0f && u + v <= 1.0f && e2.dot(q) / det > 0.0f;
+    }
+}
+
+BoundaryDescriptor::BoundaryDescriptor(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles,
+    const Vector3f& _center,
+    int _rows,
+    int _columns
+)
+    : center(_center), rows(_rows), columns(_columns)
+{
+    if (triangles.empty() || this->rows <= 0 || this->columns <= 0) {
+        return;
+    }
+    const float rowAngle = tau2 / this->rows;
+    const float columnAngle = tau / this->columns;
+
+    // Angular extent of every triangle, padded by a segment so the arcs between its corners,
+    // which bulge away from the corners' range, stay covered
+    std::vector<Footprint> footprints(triangles.size());
+    std::vector<uint32_t> indices(triangles.size());
+    std::iota(indices.begin(), indices.end(), 0u);
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](uint32_t t) {
+        const Triangle tri({ vertices[triangles[t].x()], vertices[triangles[t].y()],
+                             vertices[triangles[t].z()] });
+        Footprint& footprint = footprints[t];
+        float thetaMin = tau2, thetaMax = 0.0f;
+        std::array<float, 3> phis;
+        for (int c = 0; c < 3; c++) {
+            const Vector3f d = tri.verts[c] - this->center;
+            const float r = d.norm();
+            footprint.rMax = std::max(footprint.rMax, r);
+            const float theta = r > 0.0f ? std::acos(std::clamp(d.x() / r, -1.0f, 1.0f)) : 0.0f;
+            thetaMin = std::min(thetaMin, theta);
+            thetaMax = std::max(thetaMax, theta);
+            phis[c] = std::atan2(d.z(), d.y());
+        }
+        footprint.rMin = (closestPoint(tri, this->center) - this->center).norm();
+        footprint.firstRow = std::max((int)(thetaMin / rowAngle) - 1, 0);
+        footprint.lastRow = std::min((int)(thetaMax / rowAngle) + 1, this->rows - 1);
+
+        // Hue arc covered by the corners is the circle minus the largest gap between them
+        std::sort(phis.begin(), phis.end());
+        float gap = phis[0] + tau - phis[2];
+        float start = phis[0];
+        for (int c = 0; c < 2; c++) {
+            if (phis[c + 1] - phis[c] > gap) {
+                gap = phis[c + 1] - phis[c];
+                start = phis[c + 1];
+            }
+        }
+        const float arc = tau - gap;
+        footprint.firstColumn = (int)std::floor((start + tau2) / columnAngle) - 1;
+        footprint.columnCount = (int)std::ceil(arc / columnAngle) + 3;
+
+        // Triangles around either pole reach every hue
+        const auto& [a, b, c] = tri.verts;
+        const bool north = crosses(this->center, Vector3f::UnitX(), a, b, c);
+        const bool south = crosses(this->center, -Vector3f::UnitX(), a, b, c);
+        if (north) {
+            footprint.firstRow = 0;
+        }
+        if (south) {
+            footprint.lastRow = this->rows - 1;
+        }
+        if (north || south || arc > tau2) {
+            footprint.firstColumn = 0;
+            footprint.columnCount = this->columns;
+        }
+        footprint.columnCount = std::min(footprint.columnCount, this->columns);
+    });
+
+    // Bucket the triangles by row, then fill each row's segments in parallel
+    std::vector<std::vector<uint32_t>> rowTriangles(this->rows);
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        for (int row = footprints[t].firstRow; row <= footprints[t].lastRow; row++) {
+            rowTriangles[row].push_back(t);
+        }
+    }
+    this->segments.resize((size_t)this->rows * this->columns);
+    // Segment index and triangle of every entry, per row
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> rowEntries(this->rows);
+    std::vector<int> rowIndices(this->rows);
+    std::iota(rowIndices.begin(), rowIndices.end(), 0);
+    std::for_each(std::execution::par, rowIndices.begin(), rowIndices.end(), [&](int row) {
+        auto& entries = rowEntries[row];
+        for (uint32_t t : rowTriangles[row]) {
+            const Footprint& footprint = footprints[t];
+            for (int k = 0; k < footprint.columnCount; k++) {
+                const int column =
+                    ((footprint.firstColumn + k) % this->columns + this->columns) % this->columns;
+                const uint32_t index = (uint32_t)(row * this->columns + column);
+                Segment& segment = this->segments[index];
+                segment.rMin = std::min(segment.rMin, footprint.rMin);
+                segment.rMax = std::max(segment.rMax, footprint.rMax);
+                entries.emplace_back(index, t);
+            }
+        }
+        std::sort(entries.begin(), entries.end());
+    });
+    this->segmentStarts.assign(this->segments.size() + 1u, 0u);
+    for (const auto& entries : rowEntries) {
+        for (const auto& [index, t] : entries) {
+            this->segmentStarts[index + 1u]++;
+            this->segmentTriangles.push_back(t);
+        }
+    }
+    std::partial_sum(
+        this->segmentStarts.begin(), this->segmentStarts.end(), this->segmentStarts.begin()
+    );
+
+    size_t centerCrossings = 0u;
+    for (const Vector3u& t : triangles) {
+        centerCrossings += crosses(
+            this->center, Vector3f::UnitX(), vertices[t.x()], vertices[t.y()], vertices[t.z()]
+        );
+    }
+    this->isCenterInside = centerCrossings % 2u == 1u;
+    if (!this->isCenterInside) {
+        $warn(
+            "Gamut center ({:.1f}, {:.1f}, {:.1f}) is outside the surface", this->center.x(),
+            this->center.y(), this->center.z()
+        );
+    }
+}
+
+std::pair<int, int> BoundaryDescriptor::segmentOf(const Vector3f& direction) const
+{
+    const float r = direction.norm();
+    const float theta = r > 0.0f ? std::acos(std::clamp(direction.x() / r, -1.0f, 1.0f)) : 0.0f;
+    const float phi = std::atan2(direction.z(), direction.y());
+    const int row = std::min((int)(theta / tau2 * this->rows), this->rows - 1);
+    const int column = std::min((int)((phi + tau2) / tau * this->columns), this->columns - 1);
+    return { row, column };
+}
+
+BoundaryDescriptor::Containment BoundaryDescriptor::classify(const Vector3f& lab) const
+{
+    const Vector3f d = lab - this->center;
+    const auto [row, column] = this->segmentOf(d);
+    const Segment& segment = this->segments[row * this->columns + column];
+    const float r = d.norm();
+    if (r > segment.rMax) {
+        return Containment::outside;
+    }
+    if (r < segment.rMin) {
+        return this->isCenterInside ? Containment::inside : Containment::outside;
+    }
+    return Containment::boundary;
+}
+
+float BoundaryDescriptor::approximateDistance(const Vector3f& lab) const
+{
+    const Vector3f d = lab - this->center;
+    const auto [row, column] = this->segmentOf(d);
+    const Segment& segment = this->segments[row * this->columns + column];
+    if (segment.rMax == 0.0f) {
+        return d.norm();
+    }
+    const float offset = d.norm() - (segment.rMin + segment.rMax) / 2.0f;
+    return this->isCenterInside ? offset : -offset;
+}
+
+int BoundaryDescriptor::crossings(
+    const Vector3f& lab,
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+) const
+{
+    // The ray stays inside the segment's cone, so only the segment's triangles can cross it
+    const Vector3f d = lab - this->center;
+    const auto [row, column] = this->segmentOf(d);
+    const size_t index = (size_t)row * this->columns + column;
+    int count = 0;
+    for (uint32_t i = this->segmentStarts[index]; i < this->segmentStarts[index + 1u]; i++) {
+        const Vector3u& t = triangles[this->segmentTriangles[i]];
+        count += crosses(lab, d, vertices[t.x()], vertices[t.y()], vertices[t.z()]);
+    }
+    return count;
+}
+
+bool BoundaryDescriptor::contains(
+    const Vector3f& lab,
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+) const
+{
+    if (this->empty()) {
+        return false;
+    }
+    switch (this->classify(lab)) {
+        case Containment::inside:
+            return true;
+        case Containment::outside:
+            return false;
+        case Containment::boundary:
+            break;
+    }
+    if (lab == this->center) {
+        return this->isCenterInside;
+    }
+    return this->crossings(lab, vertices, triangles) % 2 == 1;
+}
+
+float BoundaryDescriptor::signedDistance(
+    const Vector3f& lab,
+    bool isInside,
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+) const
+{
+    if (this->empty()) {
+        return std::numeric_limits<float>::infinity();
+    }
+    const Vector3f d = lab - this->center;
+    const auto [row, column] = this->segmentOf(d);
+    const Segment& segment = this->segments[row * this->columns + column];
+    const float r = d.norm();
+    const float width = segment.rMax - segment.rMin;
+    if (r < segment.rMin - width || r > segment.rMax + width) {
+        const float distance = std::abs(this->approximateDistance(lab));
+        return isInside ? -distance : distance;
+    }
+
+    // Nearest triangle, first among the point's own segment. Anything nearer than that lies
+    // within asin(nearest / r) of the point's direction, so the search then widens to every
+    // segment within that angle, which takes more columns towards the poles.
+    const float rowAngle = tau2 / this->rows;
+    const float columnAngle = tau / this->columns;
+    float nearest = std::numeric_limits<float>::max();
+    // Triangles span several segments. Each thread stamps the ones it has measured with the
+    // current query's generation, so the buffer is cleared only when the counter wraps.
+    thread_local std::vector<uint32_t> visited;
+    thread_local uint32_t generation = 0u;
+    if (visited.size() < triangles.size()) {
+        visited.resize(triangles.size(), 0u);
+    }
+    if (++generation == 0u) {
+        std::fill(visited.begin(), visited.end(), 0u);
+        generation = 1u;
+    }
+    const auto visit = [&](size_t index) {
+        for (uint32_t i = this->segmentStarts[index]; i < this->segmentStarts[index + 1u]; i++) {
+            const uint32_t t = this->segmentTriangles[i];
+            if (visited[t] != generation) {
+                visited[t] = generation;
+                const Triangle tri({ vertices[triangles[t].x()], vertices[triangles[t].y()],
+                                     vertices[triangles[t].z()] });
+                nearest = std::min(nearest, (closestPoint(tri, lab) - lab).norm());
+            }
+        }
+    };
+    visit((size_t)row * this->columns + column);
+    const float angle = nearest < r ? std::asin(nearest / r) : tau2;
+    // Rows are widened by one since the point may sit anywhere in its own segment
+    const int rowSpan = (int)std::ceil(angle / rowAngle) + 1;
+    for (int y = std::max(row - rowSpan, 0); y <= std::min(row + rowSpan, this->rows - 1); y++) {
+        // Rows reached across a pole may be at any hue
+        const bool isPolar = y * rowAngle < angle || (this->rows - y) * rowAngle < angle;
+        const float sine = std::min(std::sin(y * rowAngle), std::sin((y + 1) * rowAngle));
+        const int span = isPolar || sine <= 0.0f
+                             ? this->columns
+                             : (int)std::ceil(angle / (columnAngle * sine)) + 1;
+        const int first = span * 2 + 1 >= this->columns ? 0 : column - span;
+        const int last = span * 2 + 1 >= this->columns ? this->columns - 1 : column + span;
+        for (int x = first; x <= last; x++) {
+            visit((size_t)y * this->columns + (x % this->columns + this->columns) % this->columns);
+        }
+    }
+    return isInside ? -nearest : nearest;
+}
@@ -0,0 +1,303 @@
+#include <bvh.hpp>
+#include <execution>
+#include <numeric>
+#include <span>
+
+namespace
+{
+    using Lane = Array<float, Bvh::lanes, 1>;
+
+    // Centroid bins evaluated per split
+    constexpr int binCount = 12;
+    // Cost of visiting a node, relative to testing one leaf's triangles
+    constexpr float traversalCost = 1.0f;
+    // Traversal stack entries reserved up front, enough for balanced trees of any practical size
+    constexpr size_t stackReserve = 64u;
+
+    struct Bounds
+    {
+        Vector3f lo = Vector3f::Constant(std::numeric_limits<float>::max());
+        Vector3f hi = Vector3f::Constant(std::numeric_limits<float>::lowest());
+
+        void grow(const Vector3f& p)
+        {
+            this->lo = this->lo.cwiseMin(p);
+            this->hi = this->hi.cwiseMax(p);
+        }
+        void grow(const Bounds& other)
+        {
+            this->lo = this->lo.cwiseMin(other.lo);
+            this->hi = this->hi.cwiseMax(other.hi);
+        }
+        float area() const
+        {
+            const Vector3f d = (this->hi - this->lo).cwiseMax(0.0f);
+            return d.x() * d.y() + d.y() * d.z() + d.z() * d.x();
+        }
+    };
+
+    struct Bin
+    {
+        Bounds bounds;
+        uint32_t count = 0u;
+    };
+
+    // Leaf test groups needed for the given number of triangles
+    float groups(uint32_t count)
+    {
+        return (float)((count + Bvh::lanes - 1u) / Bvh::lanes);
+    }
+
+    // Distance at which the ray enters the box, infinity if it misses or enters beyond maxDist
+    float enterBox(
+        const Vector3f& lo,
+        const Vector3f& hi,
+        const Vector3f& origin,
+        const Vector3f& invDir,
+        float maxDist
+    )
+    {
+        const Array3f t0 = (lo - origin).array() * invDir.array();
+        const Array3f t1 = (hi - origin).array() * invDir.array();
+        const float tNear = std::max(t0.min(t1).maxCoeff(), 0.0f);
+        const float tFar = std::min(t0.max(t1).minCoeff(), maxDist);
+        return tNear <= tFar ? tNear : std::numeric_limits<float>::infinity();
+    }
+}
+
+void Bvh::build(const std::vector<Vector3f>& vertices, const std::vector<Vector3u>& triangles)
+{
+    const uint32_t n = (uint32_t)triangles.size();
+    this->nodes.clear();
+    this->order.resize(n);
+    std::iota(this->order.begin(), this->order.end(), 0u);
+    if (n == 0u) {
+        this->gather(vertices, triangles);
+        return;
+    }
+
+    std::vector<Bounds> boxes(n);
+    std::vector<Vector3f> centroids(n);
+    std::for_each(std::execution::par, this->order.begin(), this->order.end(), [&](uint32_t t) {
+        for (int c = 0; c < 3; c++) {
+            boxes[t].grow(vertices[triangles[t][c]]);
+        }
+        centroids[t] = (boxes[t].lo + boxes[t].hi) / 2.0f;
+    });
+
+    // Children are appended after their parent, so refit can walk the nodes backwards
+    this->nodes.reserve(2u * n / lanes + 1u);
+    this->nodes.push_back({ Vector3f::Zero(), 0u, Vector3f::Zero(), n });
+    std::vector<uint32_t> stack{ 0u };
+    while (!stack.empty()) {
+        const uint32_t index = stack.back();
+        stack.pop_back();
+        const uint32_t begin = this->nodes[index].first;
+        const uint32_t count = this->nodes[index].count;
+        const auto range = std::span(this->order).subspan(begin, count);
+
+        Bounds box, centroidBox;
+        for (uint32_t t : range) {
+            box.grow(boxes[t]);
+            centroidBox.grow(centroids[t]);
+        }
+        this->nodes[index].bbMin = box.lo;
+        this->nodes[index].bbMax = box.hi;
+        if (count == 1u) {
+            continue;
+        }
+
+        // Bin centroids along the widest axis and sweep for the cheapest split
+        int axis;
+        const float extent = (centroidBox.hi - centroidBox.lo).maxCoeff(&axis);
+        const auto binOf = [&](uint32_t t) {
+            const float x = (centroids[t][axis] - centroidBox.lo[axis]) / extent;
+            return std::min((int)(x * binCount), binCount - 1);
+        };
+        float bestCost = std::numeric_limits<float>::max();
+        int bestSplit = 0;
+        if (extent > 0.0f) {
+            Bin bins[binCount];
+            for (uint32_t t : range) {
+                Bin& bin = bins[binOf(t)];
+                bin.bounds.grow(boxes[t]);
+                bin.count++;
+            }
+            float rightCosts[binCount];
+            Bounds right;
+            uint32_t rightCount = 0u;
+            for (int b = binCount - 1; b > 0; b--) {
+                right.grow(bins[b].bounds);
+                rightCount += bins[b].count;
+                rightCosts[b] = right.area() * groups(rightCount);
+            }
+            Bounds left;
+            uint32_t leftCount = 0u;
+            for (int b = 1; b < binCount; b++) {
+                left.grow(bins[b - 1].bounds);
+                leftCount += bins[b - 1].count;
+                if (leftCount == 0u || leftCount == count) {
+                    continue;
+                }
+                const float cost = traversalCost +
+                                   (left.area() * groups(leftCount) + rightCosts[b]) / box.area();
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestSplit = b;
+                }
+            }
+        }
+        if (count <= lanes && 1.0f <= bestCost) {
+            continue;
+        }
+
+        uint32_t mid;
+        if (bestSplit > 0) {
+            mid = begin + (uint32_t)(std::partition(
+                                         range.begin(), range.end(),
+                                         [&](uint32_t t) { return binOf(t) < bestSplit; }
+                                     ) -
+                                     range.begin());
+        } else {
+            // Coincident centroids, any split is as good as another
+            mid = begin + count / 2u;
+        }
+        const uint32_t child = (uint32_t)this->nodes.size();
+        this->nodes[index].first = child;
+        this->nodes[index].count = 0u;
+        this->nodes.push_back({ Vector3f::Zero(), begin, Vector3f::Zero(), mid - begin });
+        this->nodes.push_back({ Vector3f::Zero(), mid, Vector3f::Zero(), begin + count - mid });
+        stack.push_back(child);
+        stack.push_back(child + 1u);
+    }
+    this->gather(vertices, triangles);
+}
+
+void Bvh::refit(const std::vector<Vector3f>& vertices, const std::vector<Vector3u>& triangles)
+{
+    this->gather(vertices, triangles);
+    for (auto node = this->nodes.rbegin(); node != this->nodes.rend(); node++) {
+        Bounds box;
+        if (node->count == 0u) {
+            const Node& a = this->nodes[node->first];
+            const Node& b = this->nodes[node->first + 1u];
+            box.grow(Bounds{ a.bbMin, a.bbMax });
+            box.grow(Bounds{ b.bbMin, b.bbMax });
+        } else {
+            for (uint32_t slot = node->first; slot < node->first + node->count; slot++) {
+                for (int c = 0; c < 3; c++) {
+                    box.grow(vertices[triangles[this->order[slot]][c]]);
+                }
+            }
+        }
+        node->bbMin = box.lo;
+        node->bbMax = box.hi;
+    }
+}
+
+void Bvh::gather(const std::vector<Vector3f>& vertices, const std::vector<Vector3u>& triangles)
+{
+    // Padding lets the last leaf load full lanes, its extra lanes are masked out
+    const size_t slots = this->order.size() + lanes - 1u;
+    for (int axis = 0; axis < 3; axis++) {
+        this->corner[axis].assign(slots, 0.0f);
+        this->edge1[axis].assign(slots, 0.0f);
+        this->edge2[axis].assign(slots, 0.0f);
+    }
+    std::vector<uint32_t> slotIndices(this->order.size());
+    std::iota(slotIndices.begin(), slotIndices.end(), 0u);
+    std::for_each(std::execution::par, slotIndices.begin(), slotIndices.end(), [&](uint32_t s) {
+        const Vector3u& t = triangles[this->order[s]];
+        const Vector3f& v0 = vertices[t.x()];
+        const Vector3f e1 = vertices[t.y()] - v0;
+        const Vector3f e2 = vertices[t.z()] - v0;
+        for (int axis = 0; axis < 3; axis++) {
+            this->corner[axis][s] = v0[axis];
+            this->edge1[axis][s] = e1[axis];
+            this->edge2[axis][s] = e2[axis];
+        }
+    });
+}
+
+std::optional<Bvh::Hit> Bvh::intersect(const Ray& ray) const
+{
+    if (this->nodes.empty()) {
+        return std::nullopt;
+    }
+    const Vector3f& o = ray.origin;
+    const Vector3f& d = ray.direction;
+    const Vector3f invDir = d.cwiseInverse();
+    const Lane laneIndex = Lane::LinSpaced(0.0f, (float)lanes - 1.0f);
+
+    std::optional<Hit> hit;
+    float best = std::numeric_limits<float>::infinity();
+    // Nodes to visit with the distance the ray enters them
+    std::vector<std::pair<uint32_t, float>> stack;
+    stack.reserve(stackReserve);
+    const float rootDist = enterBox(this->nodes[0].bbMin, this->nodes[0].bbMax, o, invDir, best);
+    if (rootDist == std::numeric_limits<float>::infinity()) {
+        return std::nullopt;
+    }
+    stack.emplace_back(0u, rootDist);
+    while (!stack.empty()) {
+        const auto [index, entry] = stack.back();
+        stack.pop_back();
+        if (entry >= best) {
+            continue;
+        }
+        const Node& node = this->nodes[index];
+        if (node.count == 0u) {
+            // Visit the nearer child first so the farther one is often culled by the best hit
+            uint32_t near = node.first, far = node.first + 1u;
+            float nearDist = enterBox(
+                this->nodes[near].bbMin, this->nodes[near].bbMax, o, invDir, best
+            );
+            float farDist =
+                enterBox(this->nodes[far].bbMin, this->nodes[far].bbMax, o, invDir, best);
+            if (farDist < nearDist) {
+                std::swap(near, far);
+                std::swap(nearDist, farDist);
+            }
+            if (farDist < best) {
+                stack.emplace_back(far, farDist);
+            }
+            if (nearDist < best) {
+                stack.emplace_back(near, nearDist);
+            }
+            continue;
+        }
+
+        // Two-sided Moller-Trumbore on all of the leaf's triangles at once
+        const size_t s = node.first;
+        const Lane v0x = Map<const Lane>(&this->corner[0][s]) - o.x();
+        const Lane v0y = Map<const Lane>(&this->corner[1][s]) - o.y();
+        const Lane v0z = Map<const Lane>(&this->corner[2][s]) - o.z();
+        const Map<const Lane> e1x(&this->edge1[0][s]), e1y(&this->edge1[1][s]),
+            e1z(&this->edge1[2][s]);
+        const Map<const Lane> e2x(&this->edge2[0][s]), e2y(&this->edge2[1][s]),
+            e2z(&this->edge2[2][s]);
+        // p = d x e2, tvec = o - v0 = -v0, q = tvec x e1
+        const Lane px = d.y() * e2z - d.z() * e2y;
+        const Lane py = d.z() * e2x - d.x() * e2z;
+        const Lane pz = d.x() * e2y - d.y() * e2x;
+        const Lane det = e1x * px + e1y * py + e1z * pz;
+        const Lane invDet = det.inverse();
+        const Lane u = -(v0x * px + v0y * py + v0z * pz) * invDet;
+        const Lane qx = -(v0y * e1z - v0z * e1y);
+        const Lane qy = -(v0z * e1x - v0x * e1z);
+        const Lane qz = -(v0x * e1y - v0y * e1x);
+        const Lane v = (d.x() * qx + d.y() * qy + d.z() * qz) * invDet;
+        const Lane t = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+        const auto valid = (det.abs() > 1e-12f) && (u >= 0.0f) && (v >= 0.0f) &&
+                           (u + v <= 1.0f) && (t > 0.0f) && (t < best) &&
+                           (laneIndex < (float)node.count);
+        if (!valid.any()) {
+            continue;
+        }
+        int lane;
+        valid.select(t, Lane::Constant(best)).minCoeff(&lane);
+        best = t[lane];
+        hit = Hit{ this->order[s + lane], best, { u[lane], v[lane] } };
+    }
+    return hit;
+}
@@ -0,0 +1,153 @@
+#include <chromaticity.hpp>
+#include <execution>
+
+namespace
+{
+    // Chromaticities are snapped to this grid, far below visible differences, so rounding noise
+    // along the edges between primaries does not leave near-duplicate hull corners
+    constexpr float resolution = 1e-5f;
+
+    // CIE 1931 2° spectral locus from 380 to 700 nm, every 5 nm between 470 and 600 nm and
+    // coarser towards both ends where it barely moves
+    const std::vector<Vector2f> spectralXY = {
+        { 0.1741f, 0.0050f }, { 0.1733f, 0.0048f }, { 0.1714f, 0.0051f }, { 0.1644f, 0.0109f },
+        { 0.1566f, 0.0177f }, { 0.1440f, 0.0297f }, { 0.1241f, 0.0578f }, { 0.1096f, 0.0868f },
+        { 0.0913f, 0.1327f }, { 0.0687f, 0.2007f }, { 0.0454f, 0.2950f }, { 0.0235f, 0.4127f },
+        { 0.0082f, 0.5384f }, { 0.0039f, 0.6548f }, { 0.0139f, 0.7502f }, { 0.0389f, 0.8120f },
+        { 0.0743f, 0.8338f }, { 0.1142f, 0.8262f }, { 0.1547f, 0.8059f }, { 0.1929f, 0.7816f },
+        { 0.2296f, 0.7543f }, { 0.2658f, 0.7243f }, { 0.3016f, 0.6923f }, { 0.3373f, 0.6589f },
+        { 0.3731f, 0.6245f }, { 0.4087f, 0.5896f }, { 0.4441f, 0.5547f }, { 0.4788f, 0.5202f },
+        { 0.5125f, 0.4866f }, { 0.5448f, 0.4544f }, { 0.5752f, 0.4242f }, { 0.6029f, 0.3965f },
+        { 0.6270f, 0.3725f }, { 0.6658f, 0.3340f }, { 0.6915f, 0.3083f }, { 0.7079f, 0.2920f },
+        { 0.7190f, 0.2809f }, { 0.7260f, 0.2740f }, { 0.7300f, 0.2700f }, { 0.7334f, 0.2666f },
+        { 0.7347f, 0.2653f },
+    };
+
+    Vector2f xyToUV(const Vector2f& xy)
+    {
+        const float denominator = -2.0f * xy.x() + 12.0f * xy.y() + 3.0f;
+        return { 4.0f * xy.x() / denominator, 9.0f * xy.y() / denominator };
+    }
+
+    // Positive if a, b, c turn counter-clockwise
+    double turn(const Vector2f& a, const Vector2f& b, const Vector2f& c)
+    {
+        const Vector2d ab = (b - a).cast<double>(), ac = (c - a).cast<double>();
+        return ab.x() * ac.y() - ab.y() * ac.x();
+    }
+
+    bool lexicographic(const Vector2f& a, const Vector2f& b)
+    {
+        return a.x() < b.x() || (a.x() == b.x() && a.y() < b.y());
+    }
+
+    // Hull and area of a footprint whose sorted points are filled in
+    void close(chromaticity::Footprint& footprint)
+    {
+        footprint.hull = chromaticity::hull(footprint.sorted);
+        footprint.area = polygon::Region({ footprint.hull }).area();
+    }
+}
+
+namespace chromaticity
+{
+    Vector2f fromXYZ(const Vector3f& XYZ, Diagram diagram)
+    {
+        const float sum = XYZ.sum();
+        if (sum <= 1e-6f) {
+            return Vector2f::Constant(std::numeric_limits<float>::quiet_NaN());
+        }
+        const Vector2f xy(XYZ.x() / sum, XYZ.y() / sum);
+        return diagram == Diagram::xy ? xy : xyToUV(xy);
+    }
+
+    const polygon::Loop& locus(Diagram diagram)
+    {
+        static const polygon::Loop xy = spectralXY;
+        static const polygon::Loop uv = [] {
+            polygon::Loop loop(spectralXY.size());
+            std::transform(spectralXY.begin(), spectralXY.end(), loop.begin(), xyToUV);
+            return loop;
+        }();
+        return diagram == Diagram::xy ? xy : uv;
+    }
+
+    Footprint project(const std::vector<Vector3f>& labs, Diagram diagram, Gamut::Illuminant white)
+    {
+        Footprint result;
+        result.sorted.resize(labs.size());
+        std::transform(
+            std::execution::par, labs.begin(), labs.end(), result.sorted.begin(),
+            [&](const Vector3f& lab) {
+                const Vector2f p = fromXYZ(Gamut::LABtoXYZ(lab, white), diagram);
+                return Vector2f((p / resolution).array().round() * resolution);
+            }
+        );
+        // Black has no chromaticity
+        result.sorted.erase(
+            std::remove_if(
+                result.sorted.begin(), result.sorted.end(),
+                [](const Vector2f& p) { return std::isnan(p.x()); }
+            ),
+            result.sorted.end()
+        );
+        std::sort(std::execution::par, result.sorted.begin(), result.sorted.end(), lexicographic);
+        result.sorted.erase(
+            std::unique(result.sorted.begin(), result.sorted.end()), result.sorted.end()
+        );
+        close(result);
+        return result;
+    }
+
+    Footprint combine(const std::vector<const Footprint*>& footprints)
+    {
+        Footprint result;
+        std::vector<Vector2f> merged;
+        for (const Footprint* footprint : footprints) {
+            merged.resize(result.sorted.size() + footprint->sorted.size());
+            std::merge(
+                result.sorted.begin(), result.sorted.end(), footprint->sorted.begin(),
+                footprint->sorted.end(), merged.begin(), lexicographic
+            );
+            merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+            std::swap(result.sorted, merged);
+        }
+        close(result);
+        return result;
+    }
+
+    polygon::Loop hull(const std::vector<Vector2f>& sorted)
+    {
+        if (sorted.size() < 3u) {
+            return {};
+        }
+        // Lower chain left to right, then upper chain right to left, each point popping the
+        // ones it makes turn clockwise
+        polygon::Loop result;
+        result.reserve(sorted.size() + 1u);
+        for (const Vector2f& p : sorted) {
+            while (result.size() >= 2u && turn(result.end()[-2], result.back(), p) <= 0.0) {
+                result.pop_back();
+            }
+            result.push_back(p);
+        }
+        const size_t lower = result.size() + 1u;
+        for (auto it = sorted.rbegin() + 1; it != sorted.rend(); it++) {
+            while (result.size() >= lower && turn(result.end()[-2], result.back(), *it) <= 0.0) {
+                result.pop_back();
+            }
+            result.push_back(*it);
+        }
+        // The first point closes the upper chain
+        result.pop_back();
+        return result.size() >= 3u ? result : polygon::Loop{};
+    }
+
+    double overlapArea(const Footprint& a, const Footprint& b)
+    {
+        if (a.empty() || b.empty()) {
+            return 0.0;
+        }
+        return polygon::intersectionArea(polygon::Region({ a.hull }), polygon::Region({ b.hull }));
+    }
+}
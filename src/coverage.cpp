@@ -0,0 +1,349 @@
+#include <coverage.hpp>
+#include <csg.hpp>
+#include <integrals.hpp>
+#include <polygon.hpp>
+#include <slice.hpp>
+#include <execution>
+#include <numeric>
+#include <fstream>
+#include <thread>
+
+namespace
+{
+    constexpr char binaryMagic[4] = { 'C', 'O', 'V', 'M' };
+    constexpr uint32_t binaryVersion = 2u;
+
+    template <typename T> void writeValue(std::ofstream& file, const T& value)
+    {
+        file.write((const char*)&value, sizeof(T));
+    }
+
+    template <typename T> T readValue(std::ifstream& file)
+    {
+        T value{};
+        file.read((char*)&value, sizeof(T));
+        return value;
+    }
+
+    // Volume of the intersection of a and b, skipping the boolean when they are nested or apart
+    double intersectionVolume(Mesh& a, Mesh& b, double volumeA, double volumeB)
+    {
+        switch (csg::classify(a, b)) {
+            case csg::Relation::disjoint:
+                return 0.0;
+            case csg::Relation::aInsideB:
+                return volumeA;
+            case csg::Relation::bInsideA:
+                return volumeB;
+            case csg::Relation::overlapping:
+                break;
+        }
+        const std::optional<csg::Geometry> result = csg::intersect(a, b);
+        if (!result) {
+            $warn("Intersection of {} and {} failed", a.label, b.label);
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        return integrate(result->vertices, result->triangles).volume;
+    }
+}
+
+CoverageMatrix::CoverageMatrix(const std::vector<std::shared_ptr<Mesh>>& _profiles)
+    : profiles(_profiles)
+{
+    this->volumes.resize(this->profiles.size());
+    for (size_t i = 0; i < this->profiles.size(); i++) {
+        const Mesh& profile = *this->profiles[i];
+        this->volumes[i] = integrate(profile.vertices, profile.triangles).volume;
+    }
+}
+
+void CoverageMatrix::compute(size_t threads)
+{
+    std::vector<UnorderedPair<size_t>> queue;
+    for (size_t a = 0; a < this->profiles.size(); a++) {
+        for (size_t b = a + 1; b < this->profiles.size(); b++) {
+            if (!this->intersections.contains({ a, b })) {
+                queue.emplace_back(a, b);
+            }
+        }
+    }
+    $info(
+        "Computing {} of {} gamut pairs on {} threads", queue.size(),
+        this->profiles.size() * (this->profiles.size() - 1) / 2, threads
+    );
+    if (queue.empty()) {
+        return;
+    }
+
+    // Shared state the workers would otherwise build lazily and race on. CGAL builds each tree
+    // sequentially, so the profiles are built side by side.
+    std::for_each(
+        std::execution::par, this->profiles.begin(), this->profiles.end(),
+        [](const auto& profile) {
+            profile->getAabbTree();
+            profile->isConvex();
+        }
+    );
+
+    StopWatch timer("Coverage matrix");
+    std::atomic_size_t next = 0u;
+    const auto work = [&]() {
+        for (size_t k = next++; k < queue.size(); k = next++) {
+            const size_t a = queue[k].min(), b = queue[k].max();
+            const double volume = ::intersectionVolume(
+                *this->profiles[a], *this->profiles[b], this->volumes[a], this->volumes[b]
+            );
+            std::scoped_lock lock(this->intersectionsMutex);
+            this->intersections[queue[k]] = volume;
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < std::clamp(threads, size_t(1), queue.size()); t++) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    timer.stop(fmt::format("({} pairs)", queue.size()));
+}
+
+double CoverageMatrix::intersectionVolume(size_t a, size_t b) const
+{
+    if (a == b) {
+        return this->volumes[a];
+    }
+    const auto it = this->intersections.find({ a, b });
+    return it == this->intersections.end() ? std::numeric_limits<double>::quiet_NaN()
+                                           : it->second;
+}
+
+double CoverageMatrix::coverage(size_t a, size_t b) const
+{
+    if (this->volumes[a] <= 0.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return this->intersectionVolume(a, b) / this->volumes[a];
+}
+
+void CoverageMatrix::writeCsv(const fs::path& path) const
+{
+    std::ofstream file(path);
+    $assert(file.is_open(), "Failed to open {} for writing", path.string());
+    for (const auto& profile : this->profiles) {
+        file << ",\"" << profile->label << '"';
+    }
+    file << '\n';
+    for (size_t a = 0; a < this->profiles.size(); a++) {
+        file << '"' << this->profiles[a]->label << '"';
+        for (size_t b = 0; b < this->profiles.size(); b++) {
+            file << fmt::format(",{:.6f}", this->coverage(a, b));
+        }
+        file << '\n';
+    }
+    $info("Wrote coverage matrix to {}", path.string());
+}
+
+void CoverageMatrix::writeBinary(const fs::path& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    $assert(file.is_open(), "Failed to open {} for writing", path.string());
+    std::vector<uint64_t> hashes(this->profiles.size());
+    for (size_t i = 0; i < this->profiles.size(); i++) {
+        hashes[i] = this->profiles[i]->contentHash();
+    }
+
+    file.write(binaryMagic, sizeof(binaryMagic));
+    writeValue(file, binaryVersion);
+    writeValue(file, Mesh::contentHashVersion);
+    writeValue(file, (uint64_t)this->profiles.size());
+    for (size_t i = 0; i < this->profiles.size(); i++) {
+        writeValue(file, hashes[i]);
+        writeValue(file, this->volumes[i]);
+        writeValue(file, (uint32_t)this->profiles[i]->label.size());
+        file.write(this->profiles[i]->label.data(), this->profiles[i]->label.size());
+    }
+    writeValue(file, (uint64_t)this->intersections.size());
+    for (const auto& [pair, volume] : this->intersections) {
+        writeValue(file, hashes[pair.min()]);
+        writeValue(file, hashes[pair.max()]);
+        writeValue(file, volume);
+    }
+    $info("Wrote {} gamut pairs to {}", this->intersections.size(), path.string());
+}
+
+size_t CoverageMatrix::readBinary(const fs::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return 0u;
+    }
+    char magic[4];
+    file.read(magic, sizeof(magic));
+    if (!std::equal(magic, magic + 4, binaryMagic) || readValue<uint32_t>(file) != binaryVersion) {
+        $warn("{} is not a coverage matrix file", path.string());
+        return 0u;
+    }
+    if (readValue<uint32_t>(file) != Mesh::contentHashVersion) {
+        $info("{} is keyed by another content hash, not reusing it", path.string());
+        return 0u;
+    }
+
+    // Profiles may be ordered differently or missing, match them by content
+    std::unordered_map<uint64_t, size_t> indices;
+    for (size_t i = 0; i < this->profiles.size(); i++) {
+        indices[this->profiles[i]->contentHash()] = i;
+    }
+    const uint64_t nProfiles = readValue<uint64_t>(file);
+    for (uint64_t i = 0; i < nProfiles && file; i++) {
+        readValue<uint64_t>(file);
+        readValue<double>(file);
+        file.seekg(readValue<uint32_t>(file), std::ios::cur);
+    }
+    size_t reused = 0u;
+    const uint64_t nPairs = readValue<uint64_t>(file);
+    for (uint64_t p = 0; p < nPairs && file; p++) {
+        const uint64_t hashA = readValue<uint64_t>(file);
+        const uint64_t hashB = readValue<uint64_t>(file);
+        const double volume = readValue<double>(file);
+        if (file && indices.contains(hashA) && indices.contains(hashB) && !std::isnan(volume)) {
+            this->intersections[{ indices[hashA], indices[hashB] }] = volume;
+            reused++;
+        }
+    }
+    $info("Reused {} gamut pairs from {}", reused, path.string());
+    return reused;
+}
+
+CoverageCurves::CoverageCurves(
+    const std::vector<std::shared_ptr<Mesh>>& _profiles,
+    size_t levelCount
+)
+    : profiles(_profiles)
+{
+    float lo = std::numeric_limits<float>::max();
+    float hi = std::numeric_limits<float>::lowest();
+    for (const auto& profile : this->profiles) {
+        for (const Vector3f& v : profile->vertices) {
+            lo = std::min(lo, v.x());
+            hi = std::max(hi, v.x());
+        }
+    }
+    if (lo > hi || levelCount == 0u) {
+        return;
+    }
+    this->step = (hi - lo) / levelCount;
+    this->levels.resize(levelCount);
+    for (size_t k = 0; k < levelCount; k++) {
+        this->levels[k] = lo + ((float)k + 0.5f) * this->step;
+    }
+}
+
+void CoverageCurves::compute()
+{
+    const size_t nProfiles = this->profiles.size();
+    const size_t nLevels = this->levels.size();
+    StopWatch timer("Coverage curves");
+
+    // Slice every profile at every level
+    std::vector<LightnessSlicer> slicers(nProfiles);
+    std::vector<size_t> indices(nProfiles);
+    std::iota(indices.begin(), indices.end(), 0u);
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t p) {
+        slicers[p] = LightnessSlicer(this->profiles[p]->vertices, this->profiles[p]->triangles);
+    });
+    std::vector<polygon::Region> regions(nProfiles * nLevels);
+    this->areas.assign(nProfiles, std::vector<double>(nLevels));
+    indices.resize(regions.size());
+    std::iota(indices.begin(), indices.end(), 0u);
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+        const size_t p = i / nLevels, k = i % nLevels;
+        const Mesh& profile = *this->profiles[p];
+        regions[i] = slicers[p].slice(profile.vertices, profile.triangles, this->levels[k]);
+        this->areas[p][k] = regions[i].area();
+    });
+
+    // Intersect every pair at every level
+    std::vector<UnorderedPair<size_t>> pairs;
+    for (size_t a = 0; a < nProfiles; a++) {
+        for (size_t b = a + 1; b < nProfiles; b++) {
+            pairs.emplace_back(a, b);
+            this->intersections[pairs.back()].assign(nLevels, 0.0);
+        }
+    }
+    indices.resize(pairs.size() * nLevels);
+    std::iota(indices.begin(), indices.end(), 0u);
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+        const UnorderedPair<size_t>& pair = pairs[i / nLevels];
+        const size_t k = i % nLevels;
+        this->intersections.at(pair)[k] = polygon::intersectionArea(
+            regions[pair.min() * nLevels + k], regions[pair.max() * nLevels + k]
+        );
+    });
+    timer.stop(fmt::format("({} profiles, {} pairs, {} levels)", nProfiles, pairs.size(), nLevels));
+}
+
+double CoverageCurves::area(size_t a, size_t b, size_t level) const
+{
+    if (a == b) {
+        return this->areas[a][level];
+    }
+    const auto it = this->intersections.find({ a, b });
+    return it == this->intersections.end() ? std::numeric_limits<double>::quiet_NaN()
+                                           : it->second[level];
+}
+
+double CoverageCurves::volume(size_t a, size_t b) const
+{
+    double sum = 0.0;
+    for (size_t k = 0; k < this->levels.size(); k++) {
+        sum += this->area(a, b, k);
+    }
+    return sum * this->step;
+}
+
+double CoverageCurves::coverage(size_t a, size_t b) const
+{
+    const double volume = this->volume(a, a);
+    if (volume <= 0.0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    return this->volume(a, b) / volume;
+}
+
+void CoverageCurves::writeCsv(const fs::path& path) const
+{
+    std::ofstream file(path);
+    $assert(file.is_open(), "Failed to open {} for writing", path.string());
+    const size_t n = this->profiles.size();
+    file << "L";
+    for (size_t a = 0; a < n; a++) {
+        file << ",\"" << this->profiles[a]->label << '"';
+    }
+    for (size_t a = 0; a < n; a++) {
+        for (size_t b = a + 1; b < n; b++) {
+            file << ",\"" << this->profiles[a]->label << " & " << this->profiles[b]->label << '"';
+        }
+    }
+    file << '\n';
+
+    // Level rows hold areas, the last row the volumes integrated from them
+    const auto writeRow = [&](const auto& value) {
+        for (size_t a = 0; a < n; a++) {
+            file << fmt::format(",{:.4f}", value(a, a));
+        }
+        for (size_t a = 0; a < n; a++) {
+            for (size_t b = a + 1; b < n; b++) {
+                file << fmt::format(",{:.4f}", value(a, b));
+            }
+        }
+        file << '\n';
+    };
+    for (size_t k = 0; k < this->levels.size(); k++) {
+        file << fmt::format("{:.3f}", this->levels[k]);
+        writeRow([&](size_t a, size_t b) { return this->area(a, b, k); });
+    }
+    file << "volume";
+    writeRow([&](size_t a, size_t b) { return this->volume(a, b); });
+    $info("Wrote coverage curves to {}", path.string());
+}
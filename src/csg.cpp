@@ -0,0 +1,420 @@
+#include <csg.hpp>
+#include <CGAL/intersections.h>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    using Polygon = std::vector<Vector3d>;
+
+    // Closed half-space of points x where normal . x <= offset
+    struct HalfSpace
+    {
+        Vector3d normal;
+        double offset;
+
+        double distance(const Vector3d& p) const { return this->normal.dot(p) - this->offset; }
+    };
+
+    // Vertex position snapped to a grid, used to weld clipped polygon corners back together
+    struct GridKey
+    {
+        int64_t x, y, z;
+
+        bool operator==(const GridKey& other) const = default;
+        /* hashable */ size_t _hash() const
+        {
+            return cantor(cantor((uint64_t)this->x, (uint64_t)this->y), (uint64_t)this->z);
+        }
+    };
+
+    constexpr double clipEpsilon = 1e-6;
+    constexpr double weldResolution = 1e-4;
+
+    uint64_t edgeKey(uint32_t a, uint32_t b)
+    {
+        return (static_cast<uint64_t>(a) << 32) | b;
+    }
+
+    template <typename V>
+    bool lexLess(const V& a, const V& b)
+    {
+        return std::lexicographical_compare(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+    // Point where segment ab crosses the plane of h, always computed from the same endpoint so
+    // both faces sharing an edge produce the same point
+    Vector3d cut(const Vector3d& a, const Vector3d& b, const HalfSpace& h)
+    {
+        const Vector3d& p = lexLess(a, b) ? a : b;
+        const Vector3d& q = lexLess(a, b) ? b : a;
+        const double dp = h.distance(p);
+        const double dq = h.distance(q);
+        return p + (q - p) * (dp / (dp - dq));
+    }
+
+    // Orders the points of a planar convex cap counter-clockwise around the plane normal and drops
+    // duplicates
+    Polygon makeCap(Polygon points, const Vector3d& normal)
+    {
+        const Vector3d center =
+            std::accumulate(points.begin(), points.end(), Vector3d::Zero().eval()) /
+            (double)points.size();
+        const Vector3d u = normal.unitOrthogonal();
+        const Vector3d v = normal.cross(u);
+        std::sort(points.begin(), points.end(), [&](const Vector3d& a, const Vector3d& b) {
+            const Vector3d da = a - center;
+            const Vector3d db = b - center;
+            return std::atan2(da.dot(v), da.dot(u)) < std::atan2(db.dot(v), db.dot(u));
+        });
+        Polygon cap;
+        for (const Vector3d& p : points) {
+            if (cap.empty() || (p - cap.back()).norm() > clipEpsilon) {
+                cap.push_back(p);
+            }
+        }
+        while (cap.size() > 1 && (cap.front() - cap.back()).norm() <= clipEpsilon) {
+            cap.pop_back();
+        }
+        return cap;
+    }
+
+    // Clips a convex polyhedron, given as its face polygons, against a half-space
+    void clip(std::vector<Polygon>& faces, const HalfSpace& h)
+    {
+        bool anyOutside = false, anyInside = false;
+        for (const Polygon& face : faces) {
+            for (const Vector3d& p : face) {
+                const double d = h.distance(p);
+                anyOutside |= d > clipEpsilon;
+                anyInside |= d < -clipEpsilon;
+            }
+        }
+        if (!anyOutside) {
+            return;
+        }
+        if (!anyInside) {
+            faces.clear();
+            return;
+        }
+
+        std::vector<Polygon> clipped;
+        clipped.reserve(faces.size() + 1u);
+        Polygon capPoints;
+        for (const Polygon& face : faces) {
+            Polygon out;
+            for (size_t i = 0; i < face.size(); i++) {
+                const Vector3d& cur = face[i];
+                const Vector3d& next = face[(i + 1) % face.size()];
+                const double dc = h.distance(cur);
+                const double dn = h.distance(next);
+                if (dc <= clipEpsilon) {
+                    out.push_back(cur);
+                    if (dc >= -clipEpsilon) {
+                        capPoints.push_back(cur);
+                    }
+                }
+                if ((dc < -clipEpsilon && dn > clipEpsilon) ||
+                    (dc > clipEpsilon && dn < -clipEpsilon)) {
+                    out.push_back(cut(cur, next, h));
+                    capPoints.push_back(out.back());
+                }
+            }
+            if (out.size() >= 3u) {
+                clipped.push_back(std::move(out));
+            }
+        }
+        if (capPoints.size() >= 3u) {
+            Polygon cap = makeCap(std::move(capPoints), h.normal);
+            if (cap.size() >= 3u) {
+                clipped.push_back(std::move(cap));
+            }
+        }
+        faces = std::move(clipped);
+    }
+
+    // Whether two intersecting triangles meet only in a corner they share. Anything more would
+    // reach the edge opposite that corner in one of them.
+    bool meetAtCorner(const Kernel::Triangle_3& s, const Kernel::Triangle_3& t)
+    {
+        int shared = 0, si = 0, ti = 0;
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                if (s.vertex(i) == t.vertex(j)) {
+                    shared++;
+                    si = i;
+                    ti = j;
+                }
+            }
+        }
+        if (shared != 1 || t.is_degenerate()) {
+            return false;
+        }
+        const Kernel::Segment_3 sEdge(s.vertex(si + 1), s.vertex(si + 2));
+        const Kernel::Segment_3 tEdge(t.vertex(ti + 1), t.vertex(ti + 2));
+        return !CGAL::do_intersect(sEdge, t) && !CGAL::do_intersect(tEdge, s);
+    }
+
+    // Whether the surfaces of a and b meet only in vertices both have, like gamuts sharing their
+    // black point. Faces of b touching each face of a come from the AABB tree of b.
+    bool touchOnlyAtCorners(const Mesh& a, Mesh& b)
+    {
+        const AabbTree& tree = b.getAabbTree();
+        const SurfaceMesh& surface = b.getSurfaceMesh();
+        const auto toPoint = [](const Vector3f& v) { return Point3(v.x(), v.y(), v.z()); };
+        return std::all_of(
+            std::execution::par, a.triangles.begin(), a.triangles.end(),
+            [&](const Vector3u& t) {
+                const Kernel::Triangle_3 s(
+                    toPoint(a.vertices[t.x()]), toPoint(a.vertices[t.y()]),
+                    toPoint(a.vertices[t.z()])
+                );
+                // Degenerate faces are left to corefinement
+                if (s.is_degenerate()) {
+                    return false;
+                }
+                std::vector<SurfaceMesh::Face_index> faces;
+                tree.all_intersected_primitives(s, std::back_inserter(faces));
+                return std::all_of(faces.begin(), faces.end(), [&](SurfaceMesh::Face_index f) {
+                    const SurfaceMesh::Halfedge_index h = surface.halfedge(f);
+                    const Kernel::Triangle_3 u(
+                        surface.point(surface.target(surface.prev(h))),
+                        surface.point(surface.target(h)),
+                        surface.point(surface.target(surface.next(h)))
+                    );
+                    return meetAtCorner(s, u);
+                });
+            }
+        );
+    }
+
+    // Returns true if a vertex of a lies inside the closed surface of b. The vertex is taken
+    // from a triangle, isolated vertices are not part of the surface and may lie anywhere, and
+    // is not one of b, so while the surfaces meet at most in shared vertices it lies strictly
+    // on one side of b.
+    bool vertexInside(const Mesh& a, Mesh& b)
+    {
+        std::vector<Vector3f> corners = b.vertices;
+        std::sort(corners.begin(), corners.end(), lexLess<Vector3f>);
+        for (const Vector3u& t : a.triangles) {
+            for (const uint32_t v : { t.x(), t.y(), t.z() }) {
+                if (!std::binary_search(
+                        corners.begin(), corners.end(), a.vertices[v], lexLess<Vector3f>
+                    )) {
+                    return b.isInside(a.vertices[v]);
+                }
+            }
+        }
+        return false;
+    }
+
+    // Fan-triangulates polygons and welds shared corners into an indexed mesh
+    csg::Geometry weld(const std::vector<Polygon>& faces)
+    {
+        csg::Geometry geom;
+        std::unordered_map<GridKey, uint32_t> indices;
+        const auto vertexIndex = [&](const Vector3d& p) {
+            const GridKey key{ std::llround(p.x() / weldResolution),
+                               std::llround(p.y() / weldResolution),
+                               std::llround(p.z() / weldResolution) };
+            auto [it, inserted] = indices.try_emplace(key, (uint32_t)geom.vertices.size());
+            if (inserted) {
+                geom.vertices.push_back(p.cast<float>());
+            }
+            return it->second;
+        };
+        for (const Polygon& face : faces) {
+            const uint32_t i0 = vertexIndex(face[0]);
+            for (size_t i = 1; i + 1 < face.size(); i++) {
+                const Vector3u tri{ i0, vertexIndex(face[i]), vertexIndex(face[i + 1]) };
+                if (tri.x() != tri.y() && tri.y() != tri.z() && tri.z() != tri.x()) {
+                    geom.triangles.push_back(tri);
+                }
+            }
+        }
+        return geom;
+    }
+}
+
+float csg::orientation(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+)
+{
+    const double volume = std::transform_reduce(
+        std::execution::par, triangles.begin(), triangles.end(), 0.0, std::plus<>(),
+        [&](const Vector3u& t) {
+            const Vector3d v0 = vertices[t.x()].cast<double>();
+            const Vector3d v1 = vertices[t.y()].cast<double>();
+            const Vector3d v2 = vertices[t.z()].cast<double>();
+            return v0.dot(v1.cross(v2));
+        }
+    );
+    return volume >= 0.0 ? 1.0f : -1.0f;
+}
+
+bool csg::isConvex(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles,
+    float tolerance
+)
+{
+    if (triangles.empty()) {
+        return false;
+    }
+    const float sign = orientation(vertices, triangles);
+
+    // Map each directed edge to the triangle that owns it
+    std::unordered_map<uint64_t, uint32_t> edgeFaces;
+    edgeFaces.reserve(triangles.size() * 3u);
+    for (uint32_t f = 0; f < triangles.size(); f++) {
+        for (uint32_t e = 0; e < 3u; e++) {
+            const uint64_t key = edgeKey(triangles[f][e], triangles[f][(e + 1u) % 3u]);
+            if (!edgeFaces.try_emplace(key, f).second) {
+                // Non-manifold or inconsistently wound
+                return false;
+            }
+        }
+    }
+
+    return std::all_of(
+        std::execution::par, triangles.begin(), triangles.end(),
+        [&](const Vector3u& t) {
+            const Vector3f& v0 = vertices[t.x()];
+            const Vector3f n = (vertices[t.y()] - v0).cross(vertices[t.z()] - v0) * sign;
+            const float len = n.norm();
+            if (len <= std::numeric_limits<float>::epsilon()) {
+                return true;
+            }
+            for (uint32_t e = 0; e < 3u; e++) {
+                // The neighbor across this edge owns the reversed edge
+                auto it = edgeFaces.find(edgeKey(t[(e + 1u) % 3u], t[e]));
+                if (it == edgeFaces.end()) {
+                    // Open boundary
+                    return false;
+                }
+                const Vector3u& other = triangles[it->second];
+                for (uint32_t i = 0; i < 3u; i++) {
+                    const uint32_t v = other[i];
+                    if (v != t[e] && v != t[(e + 1u) % 3u] &&
+                        n.dot(vertices[v] - v0) / len > tolerance) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+    );
+}
+
+csg::Relation csg::classify(Mesh& a, Mesh& b)
+{
+    if (a.triangles.empty() || b.triangles.empty()) {
+        return Relation::disjoint;
+    }
+    if ((a.bbMax.array() < b.bbMin.array()).any() || (b.bbMax.array() < a.bbMin.array()).any()) {
+        return Relation::disjoint;
+    }
+    // Surfaces touching only in shared vertices still leave one inside the other or apart
+    if (PMP::do_intersect(a.getSurfaceMesh(), b.getSurfaceMesh()) && !touchOnlyAtCorners(a, b)) {
+        return Relation::overlapping;
+    }
+    // Surfaces do not cross, so one vertex off the other surface decides containment for the
+    // whole mesh
+    if (vertexInside(a, b)) {
+        return Relation::aInsideB;
+    }
+    if (vertexInside(b, a)) {
+        return Relation::bInsideA;
+    }
+    return Relation::disjoint;
+}
+
+csg::Geometry csg::intersectConvex(const Mesh& a, const Mesh& b)
+{
+    // Start from the faces of a, wound so that normals face outwards
+    const bool flipA = orientation(a.vertices, a.triangles) < 0.0f;
+    std::vector<Polygon> faces;
+    faces.reserve(a.triangles.size());
+    for (const Vector3u& t : a.triangles) {
+        Polygon face = { a.vertices[t.x()].cast<double>(), a.vertices[t.y()].cast<double>(),
+                         a.vertices[t.z()].cast<double>() };
+        if (flipA) {
+            std::swap(face[1], face[2]);
+        }
+        faces.push_back(std::move(face));
+    }
+
+    // Every face of b bounds a half-space that contains b
+    const double signB = orientation(b.vertices, b.triangles);
+    for (const Vector3u& t : b.triangles) {
+        const Vector3d v0 = b.vertices[t.x()].cast<double>();
+        const Vector3d v1 = b.vertices[t.y()].cast<double>();
+        const Vector3d v2 = b.vertices[t.z()].cast<double>();
+        const Vector3d n = (v1 - v0).cross(v2 - v0) * signB;
+        const double len = n.norm();
+        if (len <= clipEpsilon) {
+            continue;
+        }
+        const HalfSpace h{ n / len, (n / len).dot(v0) };
+        clip(faces, h);
+        if (faces.empty()) {
+            break;
+        }
+    }
+    return weld(faces);
+}
+
+std::optional<csg::Geometry> csg::intersectCorefine(Mesh& a, Mesh& b)
+{
+    SurfaceMesh mesh;
+    bool result = PMP::corefine_and_compute_intersection(
+        a.getSurfaceMesh(), b.getSurfaceMesh(), mesh, CGAL::parameters::do_not_modify(true),
+        CGAL::parameters::do_not_modify(true)
+    );
+    if (!result) {
+        return std::nullopt;
+    }
+    mesh.collect_garbage();
+    return toGeometry(mesh);
+}
+
+csg::Geometry csg::toGeometry(const SurfaceMesh& mesh)
+{
+    // Without removed elements indices are dense and the arrays can be filled in parallel by index
+    $assert(!mesh.has_garbage(), "Surface mesh has removed elements");
+    Geometry geom;
+    geom.vertices.resize(mesh.number_of_vertices());
+    geom.triangles.resize(mesh.number_of_faces());
+    std::vector<uint32_t> indices(std::max(geom.vertices.size(), geom.triangles.size()));
+    std::iota(indices.begin(), indices.end(), 0u);
+    std::for_each(
+        std::execution::par_unseq, indices.begin(), indices.begin() + geom.vertices.size(),
+        [&](uint32_t i) {
+            const Point3& p = mesh.point(SurfaceMesh::Vertex_index(i));
+            geom.vertices[i] = { (float)p.x(), (float)p.y(), (float)p.z() };
+        }
+    );
+    std::for_each(
+        std::execution::par_unseq, indices.begin(), indices.begin() + geom.triangles.size(),
+        [&](uint32_t i) {
+            const SurfaceMesh::Halfedge_index h = mesh.halfedge(SurfaceMesh::Face_index(i));
+            geom.triangles[i] = { mesh.target(h).idx(), mesh.target(mesh.next(h)).idx(),
+                                  mesh.target(mesh.prev(h)).idx() };
+        }
+    );
+    return geom;
+}
+
+std::optional<csg::Geometry> csg::intersect(Mesh& a, Mesh& b)
+{
+    if (a.triangles.empty() || b.triangles.empty()) {
+        return Geometry{};
+    }
+    if (a.isConvex() && b.isConvex()) {
+        $debug("Intersecting {} and {} with convex clipping", a.label, b.label);
+        return intersectConvex(a, b);
+    }
+    $debug("Intersecting {} and {} with corefinement", a.label, b.label);
+    return intersectCorefine(a, b);
+}
@@ -0,0 +1,200 @@
+#include <csg_renderer.hpp>
+#include <csg.hpp>
+
+namespace
+{
+    // Sets the winding of front faces, meshes are drawn with back faces culled
+    void setFrontFace(Mesh& mesh)
+    {
+        const float sign = csg::orientation(mesh.vertices, mesh.triangles);
+        glFrontFace(sign > 0.0f ? GL_CCW : GL_CW) $glChk;
+    }
+}
+
+csg::StencilRenderer::StencilRenderer() : program("csg")
+{
+    program.compile({
+        Shader(GL_VERTEX_SHADER, fs::path("resources/shaders/csg.vert")),
+        Shader(GL_FRAGMENT_SHADER, fs::path("resources/shaders/csg.frag")),
+    });
+    glGenFramebuffers(1, &this->fbo) $glChk;
+    glGenVertexArrays(1, &this->vao) $glChk;
+    glGenQueries(1, &this->query) $glChk;
+}
+
+csg::StencilRenderer::~StencilRenderer()
+{
+    glDeleteQueries(1, &this->query) $glChk;
+    glDeleteVertexArrays(1, &this->vao) $glChk;
+    glDeleteFramebuffers(1, &this->fbo) $glChk;
+    if (this->color.id != GL_INVALID_INDEX) {
+        glDeleteTextures(1, &this->color.id) $glChk;
+        glDeleteTextures(1, &this->depthStencil.id) $glChk;
+    }
+}
+
+void csg::StencilRenderer::resize(const Vector2i& viewport)
+{
+    if (viewport == this->size) {
+        return;
+    }
+    this->size = viewport;
+
+    gfx::TextureConfig colorConfig;
+    colorConfig.format = GL_RGBA;
+    colorConfig.internalFormat = GL_RGBA8;
+    colorConfig.width = viewport.x();
+    colorConfig.height = viewport.y();
+    colorConfig.wrap = GL_CLAMP_TO_EDGE;
+    colorConfig.filter = GL_NEAREST;
+    colorConfig.texUnit = GL_TEXTURE0;
+
+    gfx::TextureConfig depthConfig = colorConfig;
+    depthConfig.format = GL_DEPTH_STENCIL;
+    depthConfig.internalFormat = GL_DEPTH24_STENCIL8;
+    depthConfig.storageType = GL_UNSIGNED_INT_24_8;
+    depthConfig.texUnit = GL_TEXTURE1;
+
+    if (this->color.id == GL_INVALID_INDEX) {
+        this->color = gfx::Texture(colorConfig);
+        this->depthStencil = gfx::Texture(depthConfig);
+    } else {
+        this->color.reconfigure(colorConfig);
+        this->depthStencil.reconfigure(depthConfig);
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, this->fbo) $glChk;
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, this->color, 0)
+        $glChk;
+    glFramebufferTexture2D(
+        GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, this->depthStencil, 0
+    ) $glChk;
+    $assert(
+        glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE,
+        "CSG framebuffer is incomplete"
+    );
+}
+
+void csg::StencilRenderer::fullscreen(bool composite)
+{
+    this->program.use();
+    this->program.setUniform("uComposite", composite);
+    if (composite) {
+        this->color.bind();
+        this->depthStencil.bind();
+        this->program.setUniform("uColor", 0);
+        this->program.setUniform("uDepth", 1);
+    }
+    glBindVertexArray(this->vao) $glChk;
+    glDrawArrays(GL_TRIANGLES, 0, 3) $glChk;
+}
+
+void csg::StencilRenderer::drawIntersection(
+    const std::vector<std::shared_ptr<Mesh>>& meshes,
+    ShaderProgram& meshProgram
+)
+{
+    this->layersDrawn = 0;
+    if (meshes.empty()) {
+        return;
+    }
+    GLint target, viewport[4];
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target) $glChk;
+    glGetIntegerv(GL_VIEWPORT, viewport) $glChk;
+    this->resize({ viewport[2], viewport[3] });
+
+    glEnable(GL_STENCIL_TEST) $glChk;
+    glEnable(GL_CULL_FACE) $glChk;
+    // Candidates are pushed back slightly, so where meshes share a surface (gamuts with common
+    // primaries) it counts as in front of the candidate and the candidate survives
+    glPolygonOffset(1.0f, 1.0f) $glChk;
+    for (size_t i = 0; i < meshes.size(); i++) {
+        for (int layer = 0; layer < this->maxLayers; layer++) {
+            glBindFramebuffer(GL_FRAMEBUFFER, this->fbo) $glChk;
+            glClearColor(0.0f, 0.0f, 0.0f, 0.0f) $glChk;
+            glClearDepth(1.0) $glChk;
+            glClearStencil(0) $glChk;
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT) $glChk;
+
+            // Keep the depth of the layer-th front fragment of mesh i at every pixel: the stencil
+            // counts fragments in rasterization order and only the matching one writes depth
+            meshProgram.use();
+            glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE) $glChk;
+            glDepthMask(GL_TRUE) $glChk;
+            glDepthFunc(GL_ALWAYS) $glChk;
+            glStencilMask(0xFF) $glChk;
+            glStencilFunc(GL_EQUAL, layer, 0xFF) $glChk;
+            glStencilOp(GL_INCR, GL_INCR, GL_INCR) $glChk;
+            glBeginQuery(GL_ANY_SAMPLES_PASSED, this->query) $glChk;
+            glEnable(GL_POLYGON_OFFSET_FILL) $glChk;
+            setFrontFace(*meshes[i]);
+            meshes[i]->drawElements();
+            glDisable(GL_POLYGON_OFFSET_FILL) $glChk;
+            glEndQuery(GL_ANY_SAMPLES_PASSED) $glChk;
+            GLuint anySamples = GL_FALSE;
+            glGetQueryObjectuiv(this->query, GL_QUERY_RESULT, &anySamples) $glChk;
+            if (!anySamples) {
+                break;
+            }
+            this->layersDrawn++;
+
+            // Discard the candidate wherever it lies outside another mesh, that is where an even
+            // number of that mesh's surfaces lie in front of it
+            for (size_t j = 0; j < meshes.size(); j++) {
+                if (j == i) {
+                    continue;
+                }
+                glClear(GL_STENCIL_BUFFER_BIT) $glChk;
+                meshProgram.use();
+                glDisable(GL_CULL_FACE) $glChk;
+                glDepthMask(GL_FALSE) $glChk;
+                glDepthFunc(GL_LESS) $glChk;
+                glStencilMask(0x01) $glChk;
+                glStencilFunc(GL_ALWAYS, 0, 0x01) $glChk;
+                glStencilOp(GL_KEEP, GL_KEEP, GL_INVERT) $glChk;
+                meshes[j]->drawElements();
+
+                glDepthMask(GL_TRUE) $glChk;
+                glDepthFunc(GL_ALWAYS) $glChk;
+                glStencilFunc(GL_EQUAL, 0, 0x01) $glChk;
+                glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP) $glChk;
+                this->fullscreen(false);
+                glEnable(GL_CULL_FACE) $glChk;
+            }
+
+            // Shade the surviving candidates
+            meshProgram.use();
+            glDisable(GL_STENCIL_TEST) $glChk;
+            glDisable(GL_BLEND) $glChk;
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE) $glChk;
+            glDepthMask(GL_FALSE) $glChk;
+            glDepthFunc(GL_EQUAL) $glChk;
+            glEnable(GL_POLYGON_OFFSET_FILL) $glChk;
+            setFrontFace(*meshes[i]);
+            meshes[i]->drawElements();
+            glDisable(GL_POLYGON_OFFSET_FILL) $glChk;
+
+            // Merge into the target, the depth test keeps the nearest candidate
+            glBindFramebuffer(GL_FRAMEBUFFER, target) $glChk;
+            glEnable(GL_BLEND) $glChk;
+            glDepthMask(GL_TRUE) $glChk;
+            glDepthFunc(GL_LESS) $glChk;
+            glDisable(GL_CULL_FACE) $glChk;
+            this->fullscreen(true);
+            glEnable(GL_CULL_FACE) $glChk;
+            glEnable(GL_STENCIL_TEST) $glChk;
+        }
+    }
+
+    // Restore the state the rest of the frame expects
+    glBindFramebuffer(GL_FRAMEBUFFER, target) $glChk;
+    glDisable(GL_STENCIL_TEST) $glChk;
+    glDisable(GL_CULL_FACE) $glChk;
+    glFrontFace(GL_CCW) $glChk;
+    glStencilMask(0xFF) $glChk;
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE) $glChk;
+    glDepthMask(GL_TRUE) $glChk;
+    glDepthFunc(GL_LESS) $glChk;
+    glActiveTexture(GL_TEXTURE0) $glChk;
+    meshProgram.use();
+}
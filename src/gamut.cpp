@@ -1,9 +1,9 @@
 #include <gamut.hpp>
+#include <execution>
 using namespace Gamut;
 
-Vector3f Gamut::LABtoRGB(const Vector3f& lab, Illuminant ill)
+Vector3f Gamut::LABtoXYZ(const Vector3f& lab, Illuminant ill)
 {
-    // Convert CIE Lab to XYZ
     float fy = (lab.x() + 16.0f) / 116.0f;
     float fx = fy + lab.y() / 500.0f;
     float fx3 = fx * fx * fx;
@@ -14,8 +14,12 @@ Vector3f Gamut::LABtoRGB(const Vector3f& lab, Illuminant ill)
     float xr = fx3 > eps ? fx3 : (116.0f * fx - 16.f) / k;
     float yr = lab.x() > k * eps ? pow((lab.x() + 16.0f) / 116.0f, 3.0f) : lab.x() / k;
     float zr = fz3 > eps ? fz3 : (116.0f * fz - 16.0f) / k;
-    Vector3f XYZ = { xr, yr, zr };
-    XYZ = XYZ.cwiseProduct(refWhites.at(ill));
+    return Vector3f(xr, yr, zr).cwiseProduct(refWhites.at(ill));
+}
+
+Vector3f Gamut::LABtoRGB(const Vector3f& lab, Illuminant ill)
+{
+    Vector3f XYZ = LABtoXYZ(lab, ill);
 
     // Convert to D65
     if (ill != Illuminant::D65) {
@@ -60,14 +64,96 @@ std::vector<std::string> parseLine(const std::string& line)
     return tokens;
 }
 
-Gamut::GamutMesh::GamutMesh(const std::string& filepath, ShaderProgram& _program) : Mesh(_program)
+// Reads a KEYWORD "value" header line into the matching GamutData field, returns the keyword
+std::string parseHeader(const std::string& line, GamutData& data)
 {
+    const size_t split = line.find(' ');
+    const std::string key = line.substr(0, split);
+    std::string value = split == std::string::npos ? "" : line.substr(split + 1u);
+    std::erase(value, '"');
+    const auto vector = [&]() {
+        std::stringstream ss(value);
+        Vector3f v = Vector3f::Zero();
+        ss >> v.x() >> v.y() >> v.z();
+        return v;
+    };
+    if (key == "DESCRIPTOR") {
+        data.descriptor = value;
+    } else if (key == "ORIGINATOR") {
+        data.originator = value;
+    } else if (key == "CREATED") {
+        data.created = value;
+    } else if (key == "COLOR_REP") {
+        data.color_rep = value;
+    } else if (key == "GAMUT_CENTER") {
+        data.gamut_center = vector();
+    } else if (key == "CSPACE_WHITE") {
+        data.cspace_white = vector();
+    } else if (key == "GAMUT_WHITE") {
+        data.gamut_white = vector();
+    } else if (key == "CSPACE_BLACK") {
+        data.cspace_black = vector();
+    } else if (key == "GAMUT_BLACK") {
+        data.gamut_black = vector();
+    }
+    return key;
+}
+
+bool Gamut::ValidationCache::isClean(uint64_t hash)
+{
+    std::scoped_lock lock(this->mutex);
+    this->load();
+    return this->clean.contains(hash);
+}
+
+void Gamut::ValidationCache::markClean(uint64_t hash)
+{
+    std::scoped_lock lock(this->mutex);
+    this->load();
+    if (this->clean.insert(hash).second) {
+        std::ofstream file(this->path, std::ios::app);
+        file << std::hex << hash << '\n';
+    }
+}
+
+void Gamut::ValidationCache::load()
+{
+    if (this->isLoaded) {
+        return;
+    }
+    this->isLoaded = true;
+    // The first line names the content hash, a file keyed by another one starts over
+    const std::string header = fmt::format("content hash v{}", Mesh::contentHashVersion);
+    std::ifstream file(this->path);
+    std::string line;
+    if (!std::getline(file, line) || line != header) {
+        file.close();
+        std::ofstream(this->path) << header << '\n';
+        return;
+    }
+    uint64_t hash;
+    while (file >> std::hex >> hash) {
+        this->clean.insert(hash);
+    }
+    $debug("Loaded {} validated gamut hashes from {}", this->clean.size(), this->path.string());
+}
+
+Gamut::GamutMesh::GamutMesh(
+    const std::string& filepath,
+    ShaderProgram& _program,
+    Validation _validation,
+    float remeshEdgeLength
+)
+    : Mesh(_program), validation(_validation)
+{
+    this->label = fs::path(filepath).stem().string();
     std::ifstream file(filepath);
     assert(file.is_open());
 
     this->data = std::make_shared<GamutData>();
     std::string line;
     GamutSection section = GamutSection::header;
+    bool hasCenter = false;
     this->bbMin = Vector3f::Constant(std::numeric_limits<float>::max());
     this->bbMax = Vector3f::Constant(std::numeric_limits<float>::lowest());
     while (std::getline(file, line)) {
@@ -79,6 +165,8 @@ Gamut::GamutMesh::GamutMesh(const std::string& filepath, ShaderProgram& _program
             case GamutSection::header:
                 if (tokens[0] == "BEGIN_DATA") {
                     section = GamutSection::vertices;
+                } else if (parseHeader(line, *this->data) == "GAMUT_CENTER") {
+                    hasCenter = true;
                 }
                 break;
             case GamutSection::vertices:
@@ -115,29 +203,276 @@ Gamut::GamutMesh::GamutMesh(const std::string& filepath, ShaderProgram& _program
     $debug(
         "loaded gamut with {} vertices and {} faces", this->vertices.size(), this->triangles.size()
     );
+    if (remeshEdgeLength > 0.0f) {
+        this->remeshSurface(filepath, remeshEdgeLength);
+    }
+    this->integrals = integrate(this->vertices, this->triangles);
+    this->slicer = LightnessSlicer(this->vertices, this->triangles);
+    this->hueSlicer = HueSlicer(this->vertices, this->triangles);
+    if (!hasCenter) {
+        this->data->gamut_center = this->integrals.centroid;
+    }
+    this->boundary = BoundaryDescriptor(this->vertices, this->triangles, this->data->gamut_center);
+    this->occupancy = OccupancyGrid(this->vertices, this->triangles, this->bbMin, this->bbMax);
+    if (!this->getTopology().isClosed()) {
+        $debug("{} has holes, inside tests use winding numbers", this->label);
+        this->winding = WindingTree(this->vertices, this->triangles);
+    }
+    this->resample();
+    $debug("gamut volume {:.0f}, surface area {:.0f}", integrals.volume, integrals.area);
+    if (this->validation != Validation::none && !this->getTopology().ok()) {
+        $warn("gamut {} has topology defects: {}", filepath, this->getTopology()._format());
+    }
+    if (this->getTopology().isPolygonMesh()) {
+        this->buildLevels();
+    }
+}
 
-    this->generateBuffers();
+void Gamut::GamutMesh::buildSurfaceMesh()
+{
+    Mesh::buildSurfaceMesh();
+    if (this->validation == Validation::none) {
+        return;
+    }
 
-    std::vector<SurfaceMesh::vertex_index> vIndices;
-    for (Vector3f& vertex : vertices) {
-        vIndices.push_back(surfaceMesh.add_vertex(Point3(vertex.x(), vertex.y(), vertex.z())));
+    // The edge check ran on load, CGAL's repairs are only needed when it found defects
+    const TopologyReport& topology = this->getTopology();
+    if (!topology.ok()) {
+        if (!CGAL::is_closed(surfaceMesh)) {
+            $warn("{} is not closed", this->label);
+        }
+        PMP::remove_isolated_vertices(surfaceMesh);
+        PMP::duplicate_non_manifold_vertices(surfaceMesh);
+        $assert(surfaceMesh.is_valid(), "Surface mesh of {} is invalid", this->label);
+    }
+    if (this->validation == Validation::topology) {
+        return;
     }
 
-    for (Vector3u& triangle : triangles) {
-        auto f = surfaceMesh.add_face(
-            vIndices[triangle.x()], vIndices[triangle.y()], vIndices[triangle.z()]
+    // The self-intersection test builds an AABB tree over all faces, run it once per content
+    ValidationCache& cache = Singleton<ValidationCache>::get();
+    const uint64_t hash = this->contentHash();
+    if (cache.isClean(hash)) {
+        $debug("{} passed full validation before, skipping", this->label);
+        return;
+    }
+    if (PMP::does_self_intersect(surfaceMesh)) {
+        $warn("{} self-intersects, repairing", this->label);
+        PMP::experimental::remove_self_intersections(
+            surfaceMesh, CGAL::parameters::preserve_genus(false)
         );
-        $assert(f != SurfaceMesh::null_face(), "Failed to add face to surface mesh");
+        $assert(!PMP::does_self_intersect(surfaceMesh), "{} still self-intersects", this->label);
+        return;
     }
-    assert(CGAL::is_closed(surfaceMesh));
+    cache.markClean(hash);
+}
 
-    PMP::remove_isolated_vertices(surfaceMesh);
-    PMP::duplicate_non_manifold_vertices(surfaceMesh);
+void Gamut::GamutMesh::remeshSurface(const fs::path& source, float edgeLength)
+{
+    const fs::path cachePath = remesh::cachePath(source);
+    const uint64_t hash = this->contentHash();
+    const size_t before = this->triangles.size();
+    std::optional<csg::Geometry> geom = remesh::readCache(cachePath, hash, edgeLength);
+    if (!geom) {
+        if (!this->getTopology().isPolygonMesh()) {
+            $warn("{} is not a valid polygon mesh, keeping it as loaded", this->label);
+            return;
+        }
+        StopWatch timer(this->label + " remeshing");
+        geom = remesh::isotropic(this->vertices, this->triangles, edgeLength);
+        timer.stop();
+        remesh::writeCache(cachePath, hash, edgeLength, *geom);
+    }
 
-    PMP::experimental::remove_self_intersections(
-        surfaceMesh, CGAL::parameters::preserve_genus(false)
+    this->vertices = std::move(geom->vertices);
+    this->triangles = std::move(geom->triangles);
+    this->colors.resize(this->vertices.size());
+    std::transform(
+        std::execution::par, this->vertices.begin(), this->vertices.end(), this->colors.begin(),
+        [](const Vector3f& v) { return Gamut::LABtoRGB(v); }
     );
+    this->computeBounds();
+    this->geometryChanged();
+    $info(
+        "{} remeshed to edge length {:.1f}: {} -> {} triangles", this->label, edgeLength, before,
+        this->triangles.size()
+    );
+}
+
+void Gamut::GamutMesh::buildLevels()
+{
+    StopWatch timer("Gamut levels of detail");
+    const std::vector<csg::Geometry> geoms = lod::simplify(this->vertices, this->triangles);
+    for (size_t i = 0; i < geoms.size(); i++) {
+        std::vector<Vector3f> levelColors(geoms[i].vertices.size());
+        std::transform(
+            std::execution::par, geoms[i].vertices.begin(), geoms[i].vertices.end(),
+            levelColors.begin(), [](const Vector3f& v) { return Gamut::LABtoRGB(v); }
+        );
+        this->levels.push_back(std::make_shared<Mesh>(
+            geoms[i].vertices, geoms[i].triangles, levelColors, this->program
+        ));
+        this->levels.back()->label = fmt::format("{} (level {})", this->label, i + 1u);
+        this->levelErrors.push_back(lod::defaultLevels[i].maxError);
+    }
+    $debug(
+        "built {} levels of detail, coarsest has {} faces", this->levels.size(),
+        this->levels.empty() ? this->triangles.size() : this->levels.back()->triangles.size()
+    );
+}
 
-    $assert(surfaceMesh.is_valid(), "Surface mesh is invalid");
-    $assert(!PMP::does_self_intersect(surfaceMesh), "Surface mesh self-intersects");
+Mesh& Gamut::GamutMesh::levelFor(float pixelsPerUnit, float pixelTolerance)
+{
+    Mesh* level = this;
+    for (size_t i = 0; i < this->levels.size(); i++) {
+        if (this->levelErrors[i] * pixelsPerUnit > pixelTolerance) {
+            break;
+        }
+        level = this->levels[i].get();
+    }
+    return *level;
+}
+
+std::optional<Bvh::Hit> Gamut::GamutMesh::pick(const Ray& ray, float spaceInterp, float extent)
+{
+    const Matrix4f model = this->transform.matrix();
+    if (model != this->bvhTransform || spaceInterp != this->bvhSpaceInterp) {
+        std::vector<Vector3f> world(this->vertices.size());
+        std::transform(
+            std::execution::par, this->vertices.begin(), this->vertices.end(),
+            this->colors.begin(), world.begin(),
+            [&](const Vector3f& lab, const Vector3f& rgb) {
+                return this->transform * lerp(lab, Vector3f(extent * rgb), spaceInterp);
+            }
+        );
+        // Rigid motion keeps a refit tree as good as a fresh one, morphing does not
+        if (this->bvh.empty() || spaceInterp != this->bvhSpaceInterp) {
+            this->bvh.build(world, this->triangles);
+        } else {
+            this->bvh.refit(world, this->triangles);
+        }
+        this->bvhTransform = model;
+        this->bvhSpaceInterp = spaceInterp;
+    }
+    return this->bvh.intersect(ray);
+}
+
+bool Gamut::GamutMesh::contains(const Vector3f& lab) const
+{
+    // Parity tests break on surfaces with holes
+    if (!this->winding.empty()) {
+        return this->winding.contains(lab);
+    }
+    // Cells the surface passes through go on to the descriptor, which settles most of them
+    // from its segment radii before testing triangles
+    switch (this->occupancy.cell(lab)) {
+        case OccupancyGrid::Cell::inside:
+            return true;
+        case OccupancyGrid::Cell::outside:
+            return false;
+        case OccupancyGrid::Cell::boundary:
+            break;
+    }
+    return this->boundary.contains(lab, this->vertices, this->triangles);
+}
+
+float Gamut::GamutMesh::signedDistance(const Vector3f& lab) const
+{
+    return this->signedDistance(lab, this->contains(lab));
+}
+
+float Gamut::GamutMesh::signedDistance(const Vector3f& lab, bool isInside) const
+{
+    return this->boundary.signedDistance(lab, isInside, this->vertices, this->triangles);
+}
+
+namespace
+{
+    // Diverging ramp for signed distances, saturated from range on
+    Vector3f distanceColor(float distance, float range)
+    {
+        const Vector3f surface(0.85f, 0.85f, 0.85f);
+        const Vector3f inside(0.15f, 0.35f, 0.9f);
+        const Vector3f outside(0.9f, 0.2f, 0.15f);
+        const float t = std::clamp(distance / range, -1.0f, 1.0f);
+        return t < 0.0f ? lerp(surface, inside, -t) : lerp(surface, outside, t);
+    }
+}
+
+std::vector<float> Gamut::GamutMesh::signedDistances(const std::vector<Vector3f>& labs)
+{
+    const std::vector<Vector3f> closest = this->closestPoints(labs);
+    std::vector<float> result(labs.size());
+    std::transform(
+        std::execution::par, labs.begin(), labs.end(), closest.begin(), result.begin(),
+        [&](const Vector3f& lab, const Vector3f& surface) {
+            const float distance = (lab - surface).norm();
+            return this->contains(lab) ? -distance : distance;
+        }
+    );
+    return result;
+}
+
+void Gamut::GamutMesh::colorByDistance(GamutMesh& other, float range)
+{
+    StopWatch timer(this->label + " distance coloring");
+    size_t count = 0u;
+    for (Mesh* mesh : this->withLevels()) {
+        const std::vector<float> distances = other.signedDistances(mesh->vertices);
+        std::transform(
+            std::execution::par, distances.begin(), distances.end(), mesh->colors.begin(),
+            [&](float distance) { return distanceColor(distance, range); }
+        );
+        mesh->uploadColors();
+        count += distances.size();
+    }
+    timer.stop(fmt::format("({} vertices against {})", count, other.label));
+}
+
+void Gamut::GamutMesh::resetColors()
+{
+    for (Mesh* mesh : this->withLevels()) {
+        std::transform(
+            std::execution::par, mesh->vertices.begin(), mesh->vertices.end(),
+            mesh->colors.begin(), [](const Vector3f& v) { return Gamut::LABtoRGB(v); }
+        );
+        mesh->uploadColors();
+    }
+}
+
+std::vector<Mesh*> Gamut::GamutMesh::withLevels()
+{
+    std::vector<Mesh*> meshes{ this };
+    for (const auto& level : this->levels) {
+        meshes.push_back(level.get());
+    }
+    if (this->resampled) {
+        meshes.push_back(this->resampled.get());
+    }
+    return meshes;
+}
+
+void Gamut::GamutMesh::resample()
+{
+    this->sampling =
+        spherical::resample(this->vertices, this->triangles, this->data->gamut_center);
+    std::vector<Vector3f> sampleColors(this->sampling.points.size());
+    std::transform(
+        std::execution::par, this->sampling.points.begin(), this->sampling.points.end(),
+        sampleColors.begin(), [](const Vector3f& v) { return Gamut::LABtoRGB(v); }
+    );
+    this->resampled = std::make_shared<Mesh>(
+        this->sampling.points, spherical::icosphere(this->sampling.subdivisions).triangles,
+        sampleColors, this->program
+    );
+    this->resampled->label = this->label + " (resampled)";
+    this->resampled->sharedIndices = spherical::indexBuffer(this->sampling.subdivisions);
+}
+
+Vector3f Gamut::GamutMesh::labAt(const Bvh::Hit& hit) const
+{
+    const Vector3u& t = this->triangles[hit.triangle];
+    const Vector2f& w = hit.barycentric;
+    return (1.0f - w.x() - w.y()) * this->vertices[t.x()] + w.x() * this->vertices[t.y()] +
+           w.y() * this->vertices[t.z()];
 }
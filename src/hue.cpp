@@ -0,0 +1,236 @@
+#include <hue.hpp>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    // Average number of triangles per bin, as for lightness slicing
+    constexpr size_t trianglesPerBin = 8u;
+    constexpr size_t maxBins = 4096u;
+    // Chains ending this close to the L* axis are closed along it
+    constexpr float axisTolerance = 1e-3f;
+    // Keys of points where a crossing was clipped at the L* axis, above any edge key
+    constexpr uint64_t axisKeyBase = 0xFFFFFFFFull << 32;
+
+    uint64_t edgeKey(uint32_t a, uint32_t b)
+    {
+        return ((uint64_t)std::min(a, b) << 32) | std::max(a, b);
+    }
+
+    // Angle in (-pi, pi]
+    float wrap(float angle)
+    {
+        angle = std::fmod(angle + tau2, tau);
+        return angle < 0.0f ? angle + tau2 : angle - tau2;
+    }
+
+    // True if the a*b* projection of a triangle contains or touches the neutral axis
+    bool surroundsAxis(const Vector2f& p0, const Vector2f& p1, const Vector2f& p2)
+    {
+        const auto cross = [](const Vector2f& a, const Vector2f& b) {
+            return a.x() * b.y() - a.y() * b.x();
+        };
+        const float c0 = cross(p0, p1), c1 = cross(p1, p2), c2 = cross(p2, p0);
+        return (c0 >= 0.0f && c1 >= 0.0f && c2 >= 0.0f) || (c0 <= 0.0f && c1 <= 0.0f && c2 <= 0.0f);
+    }
+}
+
+HueSlicer::HueSlicer(const std::vector<Vector3f>& vertices, const std::vector<Vector3u>& triangles)
+{
+    if (triangles.empty()) {
+        return;
+    }
+    const size_t bins = std::clamp(triangles.size() / trianglesPerBin, size_t(1), maxBins);
+    this->binWidth = tau / bins;
+
+    // Hue range of every triangle, measured from its first corner so it never wraps, then
+    // counting sort into the bins
+    const auto binOf = [&](float hue) {
+        const int64_t bin = (int64_t)std::floor(hue / this->binWidth) % (int64_t)bins;
+        return (uint32_t)(bin < 0 ? bin + (int64_t)bins : bin);
+    };
+    std::vector<std::pair<uint32_t, uint32_t>> ranges(triangles.size());
+    std::vector<uint32_t> spans(triangles.size(), 0u);
+    this->binStarts.assign(bins + 1u, 0u);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        const Vector2f p0 = vertices[triangles[t].x()].tail<2>();
+        const Vector2f p1 = vertices[triangles[t].y()].tail<2>();
+        const Vector2f p2 = vertices[triangles[t].z()].tail<2>();
+        if (surroundsAxis(p0, p1, p2)) {
+            this->axisTriangles.push_back((uint32_t)t);
+            continue;
+        }
+        const float h0 = std::atan2(p0.y(), p0.x());
+        const float d1 = wrap(std::atan2(p1.y(), p1.x()) - h0);
+        const float d2 = wrap(std::atan2(p2.y(), p2.x()) - h0);
+        const float lo = h0 + std::min({ 0.0f, d1, d2 });
+        const float hi = h0 + std::max({ 0.0f, d1, d2 });
+        ranges[t] = { binOf(lo), binOf(hi) };
+        spans[t] = (ranges[t].second + (uint32_t)bins - ranges[t].first) % (uint32_t)bins + 1u;
+        for (uint32_t i = 0; i < spans[t]; i++) {
+            this->binStarts[(ranges[t].first + i) % bins + 1u]++;
+        }
+    }
+    for (size_t b = 0; b < bins; b++) {
+        this->binStarts[b + 1u] += this->binStarts[b];
+    }
+    this->binTriangles.resize(this->binStarts.back());
+    std::vector<uint32_t> fill(this->binStarts.begin(), this->binStarts.end() - 1);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        for (uint32_t i = 0; i < spans[t]; i++) {
+            this->binTriangles[fill[(ranges[t].first + i) % bins]++] = (uint32_t)t;
+        }
+    }
+}
+
+std::vector<HueSlicer::Polygon> HueSlicer::leaf(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles,
+    float hue
+) const
+{
+    if (this->binStarts.empty()) {
+        return {};
+    }
+    const size_t bins = this->binStarts.size() - 1u;
+    const float wrapped = wrap(hue) < 0.0f ? wrap(hue) + tau : wrap(hue);
+    const size_t bin = std::min((size_t)(wrapped / this->binWidth), bins - 1u);
+    const Vector2f direction(std::cos(hue), std::sin(hue));
+    // Signed distance from the plane of the leaf and chroma along its half
+    const auto side = [&](const Vector3f& v) {
+        return direction.x() * v.z() - direction.y() * v.y();
+    };
+    const auto chroma = [&](const Vector3f& v) {
+        return direction.x() * v.y() + direction.y() * v.z();
+    };
+
+    // Same chaining as lightness slices: every crossed triangle links the edge where the surface
+    // rises through the plane to the edge where it falls back. Segments reaching past the L*
+    // axis into the opposite hue are cut there, and the cut ends get keys of their own.
+    std::unordered_map<uint64_t, uint64_t> next;
+    std::unordered_map<uint64_t, Vector2f> points;
+    uint64_t axisKeys = 0u;
+    const auto crossing = [&](uint32_t a, uint32_t b) {
+        const uint64_t key = edgeKey(a, b);
+        if (!points.contains(key)) {
+            // Interpolate from the lower index so both triangles sharing the edge agree
+            const Vector3f& p = vertices[std::min(a, b)];
+            const Vector3f& q = vertices[std::max(a, b)];
+            const float t = side(p) / (side(p) - side(q));
+            points[key] = lerp(Vector2f(chroma(p), p.x()), Vector2f(chroma(q), q.x()), t);
+        }
+        return key;
+    };
+    const auto cut = [&](uint64_t from, uint64_t to) {
+        const Vector2f& p = points[from];
+        const Vector2f& q = points[to];
+        const uint64_t key = axisKeyBase | axisKeys++;
+        points[key] = { 0.0f, lerp(p.y(), q.y(), p.x() / (p.x() - q.x())) };
+        return key;
+    };
+    const auto visit = [&](uint32_t triangle) {
+        const Vector3u& t = triangles[triangle];
+        std::optional<uint64_t> rise, fall;
+        for (int c = 0; c < 3; c++) {
+            const uint32_t a = t[c], b = t[(c + 1) % 3];
+            const bool aboveA = side(vertices[a]) >= 0.0f;
+            const bool aboveB = side(vertices[b]) >= 0.0f;
+            if (!aboveA && aboveB) {
+                rise = crossing(a, b);
+            } else if (aboveA && !aboveB) {
+                fall = crossing(a, b);
+            }
+        }
+        if (!rise || !fall) {
+            return;
+        }
+        const bool riseInside = points[*rise].x() >= 0.0f;
+        const bool fallInside = points[*fall].x() >= 0.0f;
+        if (riseInside && fallInside) {
+            next[*rise] = *fall;
+        } else if (riseInside) {
+            next[*rise] = cut(*rise, *fall);
+        } else if (fallInside) {
+            next[cut(*rise, *fall)] = *fall;
+        }
+    };
+    for (uint32_t i = this->binStarts[bin]; i < this->binStarts[bin + 1u]; i++) {
+        visit(this->binTriangles[i]);
+    }
+    for (uint32_t triangle : this->axisTriangles) {
+        visit(triangle);
+    }
+
+    // Chains from the axis first, then whatever is left are closed loops
+    std::unordered_set<uint64_t> targets;
+    for (const auto& [from, to] : next) {
+        targets.insert(to);
+    }
+    std::vector<uint64_t> starts;
+    for (const auto& [from, to] : next) {
+        if (!targets.contains(from)) {
+            starts.push_back(from);
+        }
+    }
+    for (const auto& [from, to] : next) {
+        starts.push_back(from);
+    }
+
+    std::vector<Polygon> outlines;
+    std::unordered_set<uint64_t> visited;
+    size_t openChains = 0u;
+    for (const uint64_t start : starts) {
+        if (visited.contains(start)) {
+            continue;
+        }
+        Polygon outline;
+        uint64_t key = start;
+        bool closed = false;
+        while (visited.insert(key).second) {
+            outline.push_back(points[key]);
+            const auto it = next.find(key);
+            if (it == next.end()) {
+                break;
+            }
+            key = it->second;
+            closed = key == start;
+        }
+        const bool onAxis = std::abs(outline.front().x()) <= axisTolerance &&
+                            std::abs(outline.back().x()) <= axisTolerance;
+        if (closed || onAxis) {
+            outlines.push_back(std::move(outline));
+        } else {
+            openChains++;
+        }
+    }
+    if (openChains) {
+        $debug("Dropped {} open chains cutting at hue {:.1f}", openChains, hue * 360.0f / tau);
+    }
+    return outlines;
+}
+
+std::vector<Vector3f> HueSlicer::cusps(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles,
+    size_t count
+) const
+{
+    std::vector<Vector3f> result(count, Vector3f::Zero());
+    std::vector<size_t> indices(count);
+    std::iota(indices.begin(), indices.end(), 0u);
+    std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t k) {
+        const float hue = tau * (float)k / (float)count;
+        Vector2f best(-1.0f, 0.0f);
+        for (const Polygon& outline : this->leaf(vertices, triangles, hue)) {
+            for (const Vector2f& p : outline) {
+                if (p.x() > best.x()) {
+                    best = p;
+                }
+            }
+        }
+        if (best.x() >= 0.0f) {
+            result[k] = { best.y(), best.x() * std::cos(hue), best.x() * std::sin(hue) };
+        }
+    });
+    return result;
+}
@@ -0,0 +1,110 @@
+#include <integrals.hpp>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    // Triangles evaluated together, sized for a few SIMD registers of doubles
+    constexpr size_t lanes = 8u;
+    // Triangles per parallel task
+    constexpr size_t chunkSize = 1u << 14u;
+
+    using Lane = Array<double, lanes, 1>;
+
+    // Running sums of one chunk
+    struct Partial
+    {
+        // Six times the signed volume
+        double volume6 = 0.0;
+        // Twice the area
+        double area2 = 0.0;
+        // Volume-weighted sum of tetrahedron vertex sums, divided by 4 * volume6 for the centroid
+        Vector3d moment = Vector3d::Zero();
+
+        Partial operator+(const Partial& other) const
+        {
+            return { volume6 + other.volume6, area2 + other.area2, moment + other.moment };
+        }
+    };
+
+    Partial integrateChunk(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        const Vector3f& reference,
+        size_t begin,
+        size_t end
+    )
+    {
+        Lane volume6 = Lane::Zero(), area2 = Lane::Zero();
+        Lane momentX = Lane::Zero(), momentY = Lane::Zero(), momentZ = Lane::Zero();
+        // Vertex coordinates in structure-of-arrays layout, [corner][axis]
+        Lane p[3][3];
+        for (size_t base = begin; base < end; base += lanes) {
+            // Gather, padding the tail with degenerate triangles that contribute nothing
+            for (size_t l = 0; l < lanes; l++) {
+                const size_t t = base + l;
+                for (int c = 0; c < 3; c++) {
+                    const Vector3f v = t < end ? Vector3f(vertices[triangles[t][c]] - reference)
+                                               : Vector3f::Zero();
+                    p[c][0][l] = v.x();
+                    p[c][1][l] = v.y();
+                    p[c][2][l] = v.z();
+                }
+            }
+            const auto& [x0, y0, z0] = p[0];
+            const auto& [x1, y1, z1] = p[1];
+            const auto& [x2, y2, z2] = p[2];
+
+            // Signed tetrahedron (reference, v0, v1, v2): v0 . (v1 x v2)
+            const Lane det = x0 * (y1 * z2 - z1 * y2) + y0 * (z1 * x2 - x1 * z2) +
+                             z0 * (x1 * y2 - y1 * x2);
+            volume6 += det;
+            momentX += det * (x0 + x1 + x2);
+            momentY += det * (y0 + y1 + y2);
+            momentZ += det * (z0 + z1 + z2);
+
+            // Area from the cross product of two edges
+            const Lane ax = x1 - x0, ay = y1 - y0, az = z1 - z0;
+            const Lane bx = x2 - x0, by = y2 - y0, bz = z2 - z0;
+            const Lane nx = ay * bz - az * by;
+            const Lane ny = az * bx - ax * bz;
+            const Lane nz = ax * by - ay * bx;
+            area2 += (nx * nx + ny * ny + nz * nz).sqrt();
+        }
+        return { volume6.sum(), area2.sum(), { momentX.sum(), momentY.sum(), momentZ.sum() } };
+    }
+}
+
+MeshIntegrals integrate(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+)
+{
+    if (vertices.empty() || triangles.empty()) {
+        return {};
+    }
+    // Integrating around a point near the mesh keeps the tetrahedra small and the sums accurate
+    const size_t samples = std::min(vertices.size(), size_t(64));
+    const Vector3f reference =
+        std::accumulate(vertices.begin(), vertices.begin() + samples, Vector3f(Vector3f::Zero())) /
+        (float)samples;
+
+    std::vector<size_t> chunks((triangles.size() + chunkSize - 1u) / chunkSize);
+    std::iota(chunks.begin(), chunks.end(), 0u);
+    const Partial sum = std::transform_reduce(
+        std::execution::par, chunks.begin(), chunks.end(), Partial{}, std::plus<>(),
+        [&](size_t chunk) {
+            const size_t begin = chunk * chunkSize;
+            const size_t end = std::min(begin + chunkSize, triangles.size());
+            return integrateChunk(vertices, triangles, reference, begin, end);
+        }
+    );
+
+    MeshIntegrals result;
+    result.volume = std::abs(sum.volume6) / 6.0;
+    result.area = sum.area2 / 2.0;
+    if (sum.volume6 != 0.0) {
+        result.centroid = reference + (sum.moment / (4.0 * sum.volume6)).cast<float>();
+    }
+    return result;
+}
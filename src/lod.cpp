@@ -0,0 +1,66 @@
+#include <lod.hpp>
+#include <CGAL/Surface_mesh_simplification/edge_collapse.h>
+#include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/Edge_count_ratio_stop_predicate.h>
+#include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/LindstromTurk_cost.h>
+#include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/LindstromTurk_placement.h>
+#include <CGAL/Surface_mesh_simplification/Policies/Edge_collapse/Bounded_distance_placement.h>
+#include <execution>
+#include <numeric>
+
+namespace SMS = CGAL::Surface_mesh_simplification;
+
+std::vector<csg::Geometry> lod::simplify(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles,
+    const std::vector<LevelConfig>& levels,
+    size_t minTriangles
+)
+{
+    std::vector<csg::Geometry> results(levels.size());
+    std::vector<size_t> levelIndices(levels.size());
+    std::iota(levelIndices.begin(), levelIndices.end(), 0u);
+    std::for_each(std::execution::par, levelIndices.begin(), levelIndices.end(), [&](size_t i) {
+        SurfaceMesh mesh;
+        std::vector<Point3> points(vertices.size());
+        std::transform(vertices.begin(), vertices.end(), points.begin(), [](const Vector3f& v) {
+            return Point3(v.x(), v.y(), v.z());
+        });
+        PMP::polygon_soup_to_polygon_mesh(points, triangles, mesh);
+
+        const SMS::Edge_count_ratio_stop_predicate<SurfaceMesh> stop(levels[i].edgeRatio);
+        const SMS::Bounded_distance_placement<SMS::LindstromTurk_placement<SurfaceMesh>> placement(
+            levels[i].maxError
+        );
+        SMS::edge_collapse(
+            mesh, stop,
+            CGAL::parameters::get_cost(SMS::LindstromTurk_cost<SurfaceMesh>())
+                .get_placement(placement)
+        );
+        mesh.collect_garbage();
+        results[i] = csg::toGeometry(mesh);
+    });
+
+    // Tiny levels are not worth drawing, and collapses rejected by the error bound can leave a
+    // level barely smaller than the previous one, both end the chain
+    size_t kept = 0u;
+    size_t previous = triangles.size();
+    for (; kept < results.size(); kept++) {
+        const size_t size = results[kept].triangles.size();
+        if (size < minTriangles || size > previous * 9u / 10u) {
+            break;
+        }
+        previous = size;
+    }
+    results.resize(kept);
+    return results;
+}
+
+float lod::pixelsPerUnit(const Camera& cam, const Vector3f& position)
+{
+    const Matrix4f proj = cam.getProj();
+    const Vector4f clip = proj * cam.getView() * position.homogeneous();
+    if (clip.w() <= 0.0f) {
+        return 0.0f;
+    }
+    return 0.5f * cam.viewSize.y() * proj(1, 1) / clip.w();
+}
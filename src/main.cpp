@@ -3,6 +3,9 @@
 #define GLEQ_IMPLEMENTATION
 #include <gleq.h>
 #include <app.hpp>
+#include <benchmark.hpp>
+#include <coverage.hpp>
+#include <metrics.hpp>
 #include <cmath>
 #ifdef PLATFORM_WINDOWS
     #undef near
@@ -38,6 +41,70 @@ int main(int argc, char const* argv[])
 
     // Begin the application loop!
     App app({ 1280.0f, 720.0f });
+    if (std::find(argv + 1, argv + argc, std::string_view("--benchmark")) != argv + argc) {
+        bench::run(app);
+        return 0;
+    }
+    // Coverage matrix of a profile library: app --coverage [directory]
+    if (const auto arg = std::find(argv + 1, argv + argc, std::string_view("--coverage"));
+        arg != argv + argc) {
+        const bool hasDir = arg + 1 != argv + argc && !std::string_view(arg[1]).starts_with("--");
+        app.loadProfiles(hasDir ? fs::path(arg[1]) : fs::path("resources/profiles"));
+        CoverageMatrix matrix({ app.gamuts.begin(), app.gamuts.end() });
+        matrix.readBinary("coverage.bin");
+        matrix.compute();
+        matrix.writeCsv("coverage.csv");
+        matrix.writeBinary("coverage.bin");
+        return 0;
+    }
+    // Intersection areas per lightness level: app --coverage-curves [directory] [levels]
+    if (const auto arg = std::find(argv + 1, argv + argc, std::string_view("--coverage-curves"));
+        arg != argv + argc) {
+        const auto isValue = [&](const char* const* a) {
+            return a != argv + argc && !std::string_view(*a).starts_with("--");
+        };
+        const bool hasDir = isValue(arg + 1);
+        const bool hasLevels = hasDir && isValue(arg + 2);
+        app.loadProfiles(hasDir ? fs::path(arg[1]) : fs::path("resources/profiles"));
+        CoverageCurves curves(
+            { app.gamuts.begin(), app.gamuts.end() }, hasLevels ? std::stoul(arg[2]) : 100u
+        );
+        curves.compute();
+        curves.writeCsv("coverage_curves.csv");
+        return 0;
+    }
+    // Surface distances between profiles of a library: app --similarity [directory] [density]
+    if (const auto arg = std::find(argv + 1, argv + argc, std::string_view("--similarity"));
+        arg != argv + argc) {
+        const auto isValue = [&](const char* const* a) {
+            return a != argv + argc && !std::string_view(*a).starts_with("--");
+        };
+        const bool hasDir = isValue(arg + 1);
+        const bool hasDensity = hasDir && isValue(arg + 2);
+        app.loadProfiles(hasDir ? fs::path(arg[1]) : fs::path("resources/profiles"));
+        SimilarityMatrix matrix(
+            { app.gamuts.begin(), app.gamuts.end() }, hasDensity ? std::stof(arg[2]) : 0.05f
+        );
+        matrix.readBinary("similarity.bin");
+        matrix.compute();
+        matrix.writeCsv("similarity.csv");
+        matrix.writeBinary("similarity.bin");
+        return 0;
+    }
+    // Lab colors checked against a profile library: app --classify file [directory]
+    if (const auto arg = std::find(argv + 1, argv + argc, std::string_view("--classify"));
+        arg != argv + argc) {
+        $assert(arg + 1 != argv + argc, "--classify needs a file of Lab colors");
+        const bool hasDir = arg + 2 != argv + argc && !std::string_view(arg[2]).starts_with("--");
+        app.loadProfiles(hasDir ? fs::path(arg[2]) : fs::path("resources/profiles"));
+        app.classifyPoints(arg[1]);
+        if (app.pendingClassification.valid()) {
+            app.pendingClassification.wait();
+            app.collectClassification();
+        }
+        $info("{}", app.pointsSummary);
+        return 0;
+    }
     float t = 0.0f;
     while (!glfwWindowShouldClose(window)) {
         app.prepare();
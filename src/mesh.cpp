@@ -1,7 +1,10 @@
 #include <mesh.hpp>
+#include <csg.hpp>
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
+#include <CGAL/Side_of_triangle_mesh.h>
 #include <execution>
+#include <boost/property_map/function_property_map.hpp>
 
 Mesh::Mesh(const std::filesystem::path& modelPath, ShaderProgram& _program) : program(_program)
 {
@@ -34,7 +37,6 @@ Mesh::Mesh(const std::filesystem::path& modelPath, ShaderProgram& _program) : pr
             this->triangles.push_back(triangle);
         }
     }
-    this->generateBuffers();
     $info(
         "Loaded model from {} with {} vertices and {} triangles", modelPath.string(),
         this->vertices.size(), this->triangles.size()
@@ -52,7 +54,7 @@ Mesh::Mesh(
     this->vertices = _vertices;
     this->triangles = _triangles;
     this->colors = _colors;
-    this->generateBuffers();
+    this->computeBounds();
 }
 
 Mesh::Mesh(Mesh& other) : program(other.program)
@@ -60,7 +62,20 @@ Mesh::Mesh(Mesh& other) : program(other.program)
     this->vertices = other.vertices;
     this->triangles = other.triangles;
     this->colors = other.colors;
-    this->generateBuffers();
+    this->bbMin = other.bbMin;
+    this->bbMax = other.bbMax;
+    this->convex = other.convex;
+    this->topology = other.topology;
+}
+
+void Mesh::computeBounds()
+{
+    this->bbMin = Vector3f::Constant(std::numeric_limits<float>::max());
+    this->bbMax = Vector3f::Constant(std::numeric_limits<float>::lowest());
+    for (const Vector3f& v : this->vertices) {
+        this->bbMin = this->bbMin.cwiseMin(v);
+        this->bbMax = this->bbMax.cwiseMax(v);
+    }
 }
 
 void Mesh::setVertexColor(const Vector3f& color)
@@ -68,13 +83,182 @@ void Mesh::setVertexColor(const Vector3f& color)
     std::for_each(std::execution::par, this->colors.begin(), this->colors.end(), [&](Vector3f& c) {
         c = color;
     });
+    this->uploadColors();
+}
+
+void Mesh::uploadColors()
+{
+    // Buffers not created yet pick the colors up on first draw
+    if (!this->hasBuffers) {
+        return;
+    }
     glBindBuffer(GL_ARRAY_BUFFER, this->vboColors) $glChk;
     glBufferSubData(GL_ARRAY_BUFFER, 0, this->colors.size() * sizeof(Vector3f), this->colors.data())
         $glChk;
 }
 
+void Mesh::buildSurfaceMesh()
+{
+    this->surfaceMesh.clear();
+    // CGAL reads the float vertex and index arrays in place through the point map, no
+    // intermediate soup is built
+    const auto toPoint = [](const Vector3f& v) { return Point3(v.x(), v.y(), v.z()); };
+    const auto pointMap = boost::make_function_property_map<Vector3f>(toPoint);
+    if (this->getTopology().isPolygonMesh()) {
+        PMP::polygon_soup_to_polygon_mesh(
+            this->vertices, this->triangles, this->surfaceMesh,
+            CGAL::parameters::point_map(pointMap)
+        );
+        return;
+    }
+
+    // Non-manifold or inconsistently wound input needs a mutable soup to repair
+    $warn("{} is not a valid polygon mesh, repairing its triangle soup", this->label);
+    std::vector<Point3> points(this->vertices.size());
+    std::transform(this->vertices.begin(), this->vertices.end(), points.begin(), toPoint);
+    std::vector<std::vector<size_t>> polygons(this->triangles.size());
+    std::transform(
+        this->triangles.begin(), this->triangles.end(), polygons.begin(),
+        [](const Vector3u& t) { return std::vector<size_t>{ t.x(), t.y(), t.z() }; }
+    );
+    PMP::orient_polygon_soup(points, polygons);
+    PMP::polygon_soup_to_polygon_mesh(points, polygons, this->surfaceMesh);
+}
+
+SurfaceMesh& Mesh::getSurfaceMesh()
+{
+    std::scoped_lock lock(this->surfaceMeshMutex);
+    if (this->surfaceMesh.is_empty()) {
+        this->buildSurfaceMesh();
+    }
+    this->surfaceMeshUsed = std::chrono::steady_clock::now();
+    return this->surfaceMesh;
+}
+
+bool Mesh::hasSurfaceMesh() const
+{
+    std::scoped_lock lock(this->surfaceMeshMutex);
+    return !this->surfaceMesh.is_empty();
+}
+
+const AabbTree& Mesh::getAabbTree()
+{
+    // Builds the surface mesh inline, getSurfaceMesh() would take the lock a second time
+    std::scoped_lock lock(this->surfaceMeshMutex);
+    if (this->surfaceMesh.is_empty()) {
+        this->buildSurfaceMesh();
+    }
+    if (!this->aabbTree) {
+        StopWatch timer(this->label + " AABB tree");
+        const auto faceRange = faces(this->surfaceMesh);
+        this->aabbTree =
+            std::make_unique<AabbTree>(faceRange.begin(), faceRange.end(), this->surfaceMesh);
+        this->aabbTree->build();
+        // Builds the vertex search structure now, distance queries would do it lazily and race
+        this->aabbTree->accelerate_distance_queries();
+        timer.stop(fmt::format("({} faces)", this->aabbTree->size()));
+    }
+    this->surfaceMeshUsed = std::chrono::steady_clock::now();
+    return *this->aabbTree;
+}
+
+size_t Mesh::aabbTreeBytes() const
+{
+    // A primitive and a box per face, and roughly one node of two boxes per face. The search
+    // tree built for distance queries adds a point per vertex.
+    std::scoped_lock lock(this->surfaceMeshMutex);
+    if (!this->aabbTree) {
+        return 0u;
+    }
+    return this->aabbTree->size() * (sizeof(AabbPrimitive) + 3u * sizeof(CGAL::Bbox_3)) +
+           this->surfaceMesh.number_of_vertices() * sizeof(Point3);
+}
+
+bool Mesh::isInside(const Vector3f& point)
+{
+    const CGAL::Side_of_triangle_mesh<SurfaceMesh, Kernel, CGAL::Default, AabbTree> side(
+        this->getAabbTree()
+    );
+    return side(Point3(point.x(), point.y(), point.z())) == CGAL::ON_BOUNDED_SIDE;
+}
+
+Vector3f Mesh::closestPoint(const Vector3f& point)
+{
+    const Point3 closest =
+        this->getAabbTree().closest_point(Point3(point.x(), point.y(), point.z()));
+    return { (float)closest.x(), (float)closest.y(), (float)closest.z() };
+}
+
+std::vector<Vector3f> Mesh::closestPoints(const std::vector<Vector3f>& points)
+{
+    // Taken once, the lock is not held during the queries
+    const AabbTree& tree = this->getAabbTree();
+    std::vector<Vector3f> result(points.size());
+    std::transform(
+        std::execution::par, points.begin(), points.end(), result.begin(),
+        [&](const Vector3f& p) {
+            const Point3 closest = tree.closest_point(Point3(p.x(), p.y(), p.z()));
+            return Vector3f((float)closest.x(), (float)closest.y(), (float)closest.z());
+        }
+    );
+    return result;
+}
+
+void Mesh::geometryChanged()
+{
+    this->topology.reset();
+    this->convex.reset();
+    this->releaseSurfaceMesh();
+}
+
+void Mesh::releaseSurfaceMesh()
+{
+    std::scoped_lock lock(this->surfaceMeshMutex);
+    // The tree points into the surface mesh, it goes first
+    this->aabbTree.reset();
+    // Assigning a fresh mesh frees the storage, clear() may keep its capacity
+    this->surfaceMesh = SurfaceMesh();
+}
+
+size_t Mesh::surfaceMeshBytes() const
+{
+    // Point and halfedge per vertex, four indices per halfedge, halfedge per face, and a removal
+    // flag per vertex, edge and face
+    std::scoped_lock lock(this->surfaceMeshMutex);
+    const SurfaceMesh& mesh = this->surfaceMesh;
+    return mesh.number_of_vertices() * (sizeof(Point3) + sizeof(uint32_t) + 1u) +
+           mesh.number_of_halfedges() * 4u * sizeof(uint32_t) + mesh.number_of_edges() +
+           mesh.number_of_faces() * (sizeof(uint32_t) + 1u);
+}
+
+bool Mesh::isConvex()
+{
+    if (!this->convex) {
+        this->convex = csg::isConvex(this->vertices, this->triangles);
+    }
+    return *this->convex;
+}
+
+const TopologyReport& Mesh::getTopology()
+{
+    if (!this->topology) {
+        this->topology = checkTopology(this->vertices.size(), this->triangles);
+    }
+    return *this->topology;
+}
+
+uint64_t Mesh::contentHash() const
+{
+    // Counts first, so the split between vertex and triangle bytes is part of the hash
+    const uint64_t counts[2] = { this->vertices.size(), this->triangles.size() };
+    uint64_t hash = fnv1a(counts, sizeof(counts));
+    hash = fnv1a(this->vertices.data(), this->vertices.size() * sizeof(Vector3f), hash);
+    return fnv1a(this->triangles.data(), this->triangles.size() * sizeof(Vector3u), hash);
+}
+
 void Mesh::generateBuffers()
 {
+    this->hasBuffers = true;
     glGenVertexArrays(1, &this->vao) $glChk;
     glBindVertexArray(this->vao) $glChk;
     glGenBuffers(1, &this->vbo) $glChk;
@@ -85,8 +269,17 @@ void Mesh::generateBuffers()
     gfx::setbuf(GL_ARRAY_BUFFER, this->vboColors, this->colors);
     this->program.setVertexAttrib(this->vboColors, "vColor", 3, GL_FLOAT, 0u, 0u);
 
-    glGenBuffers(1, &this->ebo) $glChk;
-    gfx::setbuf(GL_ELEMENT_ARRAY_BUFFER, this->ebo, this->triangles);
+    if (!this->sharedIndices) {
+        glGenBuffers(1, &this->ebo) $glChk;
+        gfx::setbuf(GL_ELEMENT_ARRAY_BUFFER, this->ebo, this->triangles);
+        return;
+    }
+    if (this->sharedIndices->ebo == 0u) {
+        glGenBuffers(1, &this->sharedIndices->ebo) $glChk;
+        gfx::setbuf(GL_ELEMENT_ARRAY_BUFFER, this->sharedIndices->ebo, this->triangles);
+    }
+    this->ebo = this->sharedIndices->ebo;
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->ebo) $glChk;
 }
 
 void Mesh::draw(bool isWireframe)
@@ -94,6 +287,14 @@ void Mesh::draw(bool isWireframe)
     if (!this->isActive) {
         return;
     }
+    this->drawElements(isWireframe);
+}
+
+void Mesh::drawElements(bool isWireframe)
+{
+    if (!this->hasBuffers) {
+        this->generateBuffers();
+    }
     program.setUniform("uTModel", this->transform.matrix());
     glBindVertexArray(vao) $glChk;
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo) $glChk;
@@ -104,8 +305,20 @@ void Mesh::draw(bool isWireframe)
 
 Mesh::~Mesh()
 {
+    if (!this->hasBuffers) {
+        return;
+    }
     glDeleteBuffers(1, &this->vbo) $glChk;
-    glDeleteBuffers(1, &this->ebo) $glChk;
+    if (!this->sharedIndices) {
+        glDeleteBuffers(1, &this->ebo) $glChk;
+    }
     glDeleteBuffers(1, &this->vboColors) $glChk;
     glDeleteVertexArrays(1, &this->vao) $glChk;
-}
\ No newline at end of file
+}
+
+SharedIndexBuffer::~SharedIndexBuffer()
+{
+    if (this->ebo != 0u) {
+        glDeleteBuffers(1, &this->ebo) $glChk;
+    }
+}
@@ -0,0 +1,258 @@
+#include <metrics.hpp>
+#include <integrals.hpp>
+#include <execution>
+#include <fstream>
+#include <numeric>
+
+namespace
+{
+    constexpr char binaryMagic[4] = { 'S', 'I', 'M', 'M' };
+    constexpr uint32_t binaryVersion = 2u;
+
+    template <typename T> void writeValue(std::ofstream& file, const T& value)
+    {
+        file.write((const char*)&value, sizeof(T));
+    }
+
+    template <typename T> T readValue(std::ifstream& file)
+    {
+        T value{};
+        file.read((char*)&value, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Area-weighted points on a surface. Sample k sits at (k + 0.5) / count along the
+     *        cumulative triangle areas, so triangles get samples in proportion to their area,
+     *        and at the k-th point of the R2 low-discrepancy sequence within its triangle. Every
+     *        sample depends on k alone, so they are placed in parallel and reproducibly.
+     */
+    std::vector<Vector3f> sampleSurface(const Mesh& mesh, size_t count)
+    {
+        const std::vector<Vector3f>& V = mesh.vertices;
+        std::vector<double> cumulative(mesh.triangles.size());
+        std::transform(
+            std::execution::par, mesh.triangles.begin(), mesh.triangles.end(), cumulative.begin(),
+            [&](const Vector3u& t) {
+                return (double)(V[t.y()] - V[t.x()]).cross(V[t.z()] - V[t.x()]).norm() / 2.0;
+            }
+        );
+        std::inclusive_scan(cumulative.begin(), cumulative.end(), cumulative.begin());
+        if (cumulative.empty() || cumulative.back() <= 0.0) {
+            return {};
+        }
+
+        // Plastic number steps of the R2 sequence
+        constexpr double r2x = 0.7548776662466927, r2y = 0.5698402909980532;
+        std::vector<Vector3f> samples(count);
+        std::vector<size_t> indices(count);
+        std::iota(indices.begin(), indices.end(), 0u);
+        std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t k) {
+            const double position = ((double)k + 0.5) / (double)count * cumulative.back();
+            const size_t triangle = std::min(
+                (size_t)(std::upper_bound(cumulative.begin(), cumulative.end(), position) -
+                         cumulative.begin()),
+                cumulative.size() - 1u
+            );
+            float u = (float)std::fmod(0.5 + r2x * (double)k, 1.0);
+            float v = (float)std::fmod(0.5 + r2y * (double)k, 1.0);
+            // Folds the unit square onto the triangle
+            if (u + v > 1.0f) {
+                u = 1.0f - u;
+                v = 1.0f - v;
+            }
+            const Vector3u& t = mesh.triangles[triangle];
+            samples[k] = V[t.x()] + u * (V[t.y()] - V[t.x()]) + v * (V[t.z()] - V[t.x()]);
+        });
+        return samples;
+    }
+
+    // Largest and mean distance from samples to the surface of a mesh
+    std::pair<double, double> distances(const std::vector<Vector3f>& samples, Mesh& mesh)
+    {
+        if (samples.empty()) {
+            return { 0.0, 0.0 };
+        }
+        const std::vector<Vector3f> closest = mesh.closestPoints(samples);
+        std::vector<double> lengths(samples.size());
+        std::transform(
+            std::execution::par, samples.begin(), samples.end(), closest.begin(), lengths.begin(),
+            [](const Vector3f& sample, const Vector3f& surface) {
+                return (double)(sample - surface).norm();
+            }
+        );
+        const double max = *std::max_element(lengths.begin(), lengths.end());
+        const double sum = std::reduce(std::execution::par, lengths.begin(), lengths.end());
+        return { max, sum / (double)lengths.size() };
+    }
+}
+
+SimilarityMatrix::SimilarityMatrix(
+    const std::vector<std::shared_ptr<Mesh>>& _profiles,
+    float _density
+)
+    : profiles(_profiles), density(_density)
+{
+    this->volumes.resize(this->profiles.size());
+    this->hashes.resize(this->profiles.size());
+    for (size_t i = 0; i < this->profiles.size(); i++) {
+        const Mesh& profile = *this->profiles[i];
+        this->volumes[i] = integrate(profile.vertices, profile.triangles).volume;
+        this->hashes[i] = profile.contentHash();
+    }
+}
+
+void SimilarityMatrix::compute()
+{
+    // Pairs of distinct contents not measured yet, duplicates measure zero and are skipped
+    std::vector<UnorderedPair<size_t>> queue;
+    std::unordered_set<Key> queued;
+    std::vector<bool> isNeeded(this->profiles.size(), false);
+    for (size_t a = 0; a < this->profiles.size(); a++) {
+        for (size_t b = a + 1u; b < this->profiles.size(); b++) {
+            const Key key = this->key(a, b);
+            if (key.first == key.second || this->results.contains(key) ||
+                !queued.insert(key).second) {
+                continue;
+            }
+            queue.emplace_back(a, b);
+            isNeeded[a] = isNeeded[b] = true;
+        }
+    }
+    $info(
+        "Measuring {} of {} gamut pairs at {} samples per square unit", queue.size(),
+        this->profiles.size() * (this->profiles.size() - 1) / 2, this->density
+    );
+    if (queue.empty()) {
+        return;
+    }
+
+    // Every surface is sampled once and its tree built once, trees of different profiles side
+    // by side since CGAL builds each one sequentially
+    StopWatch timer("Similarity matrix");
+    std::vector<size_t> needed;
+    for (size_t i = 0; i < this->profiles.size(); i++) {
+        if (isNeeded[i]) {
+            needed.push_back(i);
+        }
+    }
+    std::vector<std::vector<Vector3f>> samples(this->profiles.size());
+    std::for_each(std::execution::par, needed.begin(), needed.end(), [&](size_t i) {
+        Mesh& profile = *this->profiles[i];
+        const double area = integrate(profile.vertices, profile.triangles).area;
+        samples[i] = sampleSurface(
+            profile, std::max(this->minSamples, (size_t)(area * (double)this->density))
+        );
+        profile.getAabbTree();
+    });
+
+    // The queries within a pair already run in parallel
+    for (const UnorderedPair<size_t>& pair : queue) {
+        const size_t a = pair.min(), b = pair.max();
+        Metrics metrics;
+        std::tie(metrics.maxAB, metrics.meanAB) = distances(samples[a], *this->profiles[b]);
+        std::tie(metrics.maxBA, metrics.meanBA) = distances(samples[b], *this->profiles[a]);
+        this->results[this->key(a, b)] =
+            this->hashes[a] <= this->hashes[b] ? metrics : metrics.swapped();
+    }
+    timer.stop(fmt::format("({} pairs)", queue.size()));
+}
+
+std::optional<SimilarityMatrix::Metrics> SimilarityMatrix::metrics(size_t a, size_t b) const
+{
+    if (this->hashes[a] == this->hashes[b]) {
+        return Metrics{};
+    }
+    const auto it = this->results.find(this->key(a, b));
+    if (it == this->results.end()) {
+        return std::nullopt;
+    }
+    return this->hashes[a] < this->hashes[b] ? it->second : it->second.swapped();
+}
+
+double SimilarityMatrix::volumeDifference(size_t a, size_t b) const
+{
+    const double larger = std::max(this->volumes[a], this->volumes[b]);
+    return larger > 0.0 ? std::abs(this->volumes[a] - this->volumes[b]) / larger : 0.0;
+}
+
+void SimilarityMatrix::writeCsv(const fs::path& path) const
+{
+    std::ofstream file(path);
+    $assert(file.is_open(), "Failed to open {} for writing", path.string());
+    file << "a,b,hausdorff,mean distance,max a to b,max b to a,mean a to b,mean b to a,"
+            "volume a,volume b,volume difference\n";
+    for (size_t a = 0; a < this->profiles.size(); a++) {
+        for (size_t b = a + 1u; b < this->profiles.size(); b++) {
+            constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+            const Metrics m = this->metrics(a, b).value_or(Metrics{ nan, nan, nan, nan });
+            file << fmt::format(
+                "\"{}\",\"{}\",{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.4f},{:.1f},{:.1f},{:.6f}\n",
+                this->profiles[a]->label, this->profiles[b]->label, m.hausdorff(),
+                m.meanDistance(), m.maxAB, m.maxBA, m.meanAB, m.meanBA, this->volumes[a],
+                this->volumes[b], this->volumeDifference(a, b)
+            );
+        }
+    }
+    $info("Wrote similarity matrix to {}", path.string());
+}
+
+void SimilarityMatrix::writeBinary(const fs::path& path) const
+{
+    std::ofstream file(path, std::ios::binary);
+    $assert(file.is_open(), "Failed to open {} for writing", path.string());
+    file.write(binaryMagic, sizeof(binaryMagic));
+    writeValue(file, binaryVersion);
+    writeValue(file, Mesh::contentHashVersion);
+    writeValue(file, this->density);
+    writeValue(file, (uint64_t)this->minSamples);
+    writeValue(file, (uint64_t)this->results.size());
+    for (const auto& [key, metrics] : this->results) {
+        writeValue(file, key.first);
+        writeValue(file, key.second);
+        writeValue(file, metrics);
+    }
+    $info("Wrote {} gamut pairs to {}", this->results.size(), path.string());
+}
+
+size_t SimilarityMatrix::readBinary(const fs::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return 0u;
+    }
+    char magic[4];
+    file.read(magic, sizeof(magic));
+    if (!std::equal(magic, magic + 4, binaryMagic) || readValue<uint32_t>(file) != binaryVersion) {
+        $warn("{} is not a similarity matrix file", path.string());
+        return 0u;
+    }
+    if (readValue<uint32_t>(file) != Mesh::contentHashVersion) {
+        $info("{} is keyed by another content hash, not reusing it", path.string());
+        return 0u;
+    }
+    // Metrics sampled differently are not comparable
+    const float fileDensity = readValue<float>(file);
+    const uint64_t fileMinSamples = readValue<uint64_t>(file);
+    if (fileDensity != this->density || fileMinSamples != this->minSamples) {
+        $info("{} was sampled at a different density, not reusing it", path.string());
+        return 0u;
+    }
+
+    // Pairs of contents no longer loaded are kept, so the file can be written back whole
+    std::unordered_set<uint64_t> loaded(this->hashes.begin(), this->hashes.end());
+    size_t reused = 0u;
+    const uint64_t nPairs = readValue<uint64_t>(file);
+    for (uint64_t p = 0; p < nPairs && file; p++) {
+        Key key;
+        key.first = readValue<uint64_t>(file);
+        key.second = readValue<uint64_t>(file);
+        const Metrics metrics = readValue<Metrics>(file);
+        if (file) {
+            this->results[key] = metrics;
+            reused += loaded.contains(key.first) && loaded.contains(key.second);
+        }
+    }
+    $info("Reused {} gamut pairs from {}", reused, path.string());
+    return reused;
+}
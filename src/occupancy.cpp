@@ -0,0 +1,190 @@
+#include <occupancy.hpp>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    float cross2(const Vector2f& a, const Vector2f& b)
+    {
+        return a.x() * b.y() - a.y() * b.x();
+    }
+}
+
+OccupancyGrid::OccupancyGrid(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles,
+    const Vector3f& bbMin,
+    const Vector3f& bbMax,
+    float _cellSize
+)
+    : cellSize(_cellSize)
+{
+    if (triangles.empty() || (bbMax.array() < bbMin.array()).any()) {
+        return;
+    }
+    // One cell of padding keeps the surface off the grid's faces
+    this->origin = bbMin.array() - this->cellSize;
+    this->dims = ((bbMax - bbMin) / this->cellSize).array().ceil().cast<int>() + 2;
+    this->rowWords = ((size_t)this->dims.x() + 63u) / 64u;
+    const size_t rows = (size_t)this->dims.y() * this->dims.z();
+    this->insideBits.assign(rows * this->rowWords, 0u);
+    this->boundaryBits.assign(rows * this->rowWords, 0u);
+
+    // Cell range of every triangle's bounds, binned by z layer and by x row
+    const auto cellRange = [&](uint32_t t) {
+        const Vector3f& a = vertices[triangles[t].x()];
+        const Vector3f& b = vertices[triangles[t].y()];
+        const Vector3f& c = vertices[triangles[t].z()];
+        const Vector3f lo = (a.cwiseMin(b).cwiseMin(c) - this->origin) / this->cellSize;
+        const Vector3f hi = (a.cwiseMax(b).cwiseMax(c) - this->origin) / this->cellSize;
+        return std::pair<Vector3i, Vector3i>{
+            lo.array().floor().cast<int>().max(0),
+            hi.array().floor().cast<int>().min(this->dims.array() - 1),
+        };
+    };
+    std::vector<std::vector<uint32_t>> layers(this->dims.z());
+    this->rowStarts.assign(rows + 1u, 0u);
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        const auto [lo, hi] = cellRange(t);
+        for (int z = lo.z(); z <= hi.z(); z++) {
+            layers[z].push_back(t);
+            for (int y = lo.y(); y <= hi.y(); y++) {
+                this->rowStarts[this->rowIndex(y, z) + 1u]++;
+            }
+        }
+    }
+    std::partial_sum(this->rowStarts.begin(), this->rowStarts.end(), this->rowStarts.begin());
+    this->rowTriangles.resize(this->rowStarts.back());
+    std::vector<uint32_t> fill(this->rowStarts.begin(), this->rowStarts.end() - 1);
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        const auto [lo, hi] = cellRange(t);
+        for (int z = lo.z(); z <= hi.z(); z++) {
+            for (int y = lo.y(); y <= hi.y(); y++) {
+                this->rowTriangles[fill[this->rowIndex(y, z)]++] = t;
+            }
+        }
+    }
+
+    // Boundary cells, those in a triangle's bounds that its plane passes through
+    const float halfSize = this->cellSize / 2.0f;
+    std::vector<int> layerIndices(this->dims.z());
+    std::iota(layerIndices.begin(), layerIndices.end(), 0);
+    std::for_each(std::execution::par, layerIndices.begin(), layerIndices.end(), [&](int z) {
+        for (uint32_t t : layers[z]) {
+            const Vector3f& a = vertices[triangles[t].x()];
+            const Vector3f& b = vertices[triangles[t].y()];
+            const Vector3f& c = vertices[triangles[t].z()];
+            const Vector3f n = (b - a).cross(c - a);
+            const float reach = halfSize * n.cwiseAbs().sum();
+            const auto [lo, hi] = cellRange(t);
+            for (int y = lo.y(); y <= hi.y(); y++) {
+                for (int x = lo.x(); x <= hi.x(); x++) {
+                    const Vector3f center = this->origin.array() + halfSize +
+                                            Vector3f(x, y, z).array() * this->cellSize;
+                    if (std::abs(n.dot(center - a)) <= reach) {
+                        const auto [word, mask] = this->bit(x, y, z);
+                        this->boundaryBits[word] |= mask;
+                    }
+                }
+            }
+        }
+    });
+
+    // Remaining cells hold no surface, so the parity at their center holds for all of them
+    const Array2f nudge(0.5f + 1.3e-4f, 0.5f + 1.7e-4f);
+    std::vector<size_t> rowIndices(rows);
+    std::iota(rowIndices.begin(), rowIndices.end(), 0u);
+    std::for_each(std::execution::par, rowIndices.begin(), rowIndices.end(), [&](size_t row) {
+        const int y = (int)(row % this->dims.y());
+        const int z = (int)(row / this->dims.y());
+        // Nudged off the cell centers so lines do not pass exactly through mesh edges
+        const Vector2f yz = this->origin.tail<2>() +
+                            (Vector2f(y, z).array() + nudge).matrix() * this->cellSize;
+        const std::vector<float> hits = this->crossings(row, yz, vertices, triangles);
+        bool inside = false;
+        size_t h = 0u;
+        for (int x = 0; x < this->dims.x(); x++) {
+            const float center = this->origin.x() + (x + 0.5f) * this->cellSize;
+            for (; h < hits.size() && hits[h] < center; h++) {
+                inside = !inside;
+            }
+            const auto [word, mask] = this->bit(x, y, z);
+            if (inside && !(this->boundaryBits[word] & mask)) {
+                this->insideBits[word] |= mask;
+            }
+        }
+    });
+}
+
+std::vector<float> OccupancyGrid::crossings(
+    size_t row,
+    const Vector2f& yz,
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+) const
+{
+    std::vector<float> hits;
+    for (uint32_t i = this->rowStarts[row]; i < this->rowStarts[row + 1u]; i++) {
+        const Vector3u& t = triangles[this->rowTriangles[i]];
+        const Vector3f& a = vertices[t.x()];
+        const Vector3f& b = vertices[t.y()];
+        const Vector3f& c = vertices[t.z()];
+        const Vector2f a2 = a.tail<2>(), b2 = b.tail<2>(), c2 = c.tail<2>();
+        const float area = cross2(b2 - a2, c2 - a2);
+        if (std::abs(area) <= std::numeric_limits<float>::epsilon()) {
+            continue;
+        }
+        const float la = cross2(c2 - b2, yz - b2) / area;
+        const float lb = cross2(a2 - c2, yz - c2) / area;
+        const float lc = 1.0f - la - lb;
+        if (la >= 0.0f && lb >= 0.0f && lc >= 0.0f) {
+            hits.push_back(la * a.x() + lb * b.x() + lc * c.x());
+        }
+    }
+    std::sort(hits.begin(), hits.end());
+    return hits;
+}
+
+OccupancyGrid::Cell OccupancyGrid::cell(const Vector3f& point) const
+{
+    if (this->empty()) {
+        return Cell::outside;
+    }
+    const Vector3i index = ((point - this->origin) / this->cellSize).array().floor().cast<int>();
+    if ((index.array() < 0).any() || (index.array() >= this->dims.array()).any()) {
+        return Cell::outside;
+    }
+    const auto [word, mask] = this->bit(index.x(), index.y(), index.z());
+    if (this->boundaryBits[word] & mask) {
+        return Cell::boundary;
+    }
+    return this->insideBits[word] & mask ? Cell::inside : Cell::outside;
+}
+
+bool OccupancyGrid::contains(
+    const Vector3f& point,
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+) const
+{
+    switch (this->cell(point)) {
+        case Cell::inside:
+            return true;
+        case Cell::outside:
+            return false;
+        case Cell::boundary:
+            break;
+    }
+    const Vector3i index = ((point - this->origin) / this->cellSize).array().floor().cast<int>();
+    const std::vector<float> hits = this->crossings(
+        this->rowIndex(index.y(), index.z()), point.tail<2>(), vertices, triangles
+    );
+    // Crossings before the point, the line starts outside
+    return (std::upper_bound(hits.begin(), hits.end(), point.x()) - hits.begin()) % 2 == 1;
+}
+
+size_t OccupancyGrid::memoryBytes() const
+{
+    return (this->insideBits.size() + this->boundaryBits.size()) * sizeof(uint64_t) +
+           (this->rowStarts.size() + this->rowTriangles.size()) * sizeof(uint32_t);
+}
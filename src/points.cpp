@@ -0,0 +1,116 @@
+#include <points.hpp>
+#include <execution>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+namespace
+{
+    // Points per parallel task
+    constexpr size_t chunkSize = 4096u;
+}
+
+namespace points
+{
+    Classification classify(
+        const std::vector<Vector3f>& points,
+        const std::vector<std::shared_ptr<Gamut::GamutMesh>>& gamuts,
+        bool withDistances
+    )
+    {
+        Classification result;
+        result.gamutCount = std::min(gamuts.size(), maxGamuts);
+        if (gamuts.size() > maxGamuts) {
+            $warn("Classifying against the first {} of {} gamuts", maxGamuts, gamuts.size());
+        }
+        result.masks.assign(points.size(), 0u);
+        if (withDistances) {
+            result.distances.resize(points.size() * result.gamutCount);
+        }
+
+        StopWatch timer("Point classification");
+        std::vector<size_t> chunks((points.size() + chunkSize - 1u) / chunkSize);
+        std::iota(chunks.begin(), chunks.end(), 0u);
+        std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk) {
+            const size_t begin = chunk * chunkSize;
+            const size_t end = std::min(begin + chunkSize, points.size());
+            for (size_t g = 0; g < result.gamutCount; g++) {
+                const Gamut::GamutMesh& gamut = *gamuts[g];
+                for (size_t p = begin; p < end; p++) {
+                    result.masks[p] |= (uint64_t)gamut.contains(points[p]) << g;
+                }
+                if (withDistances) {
+                    for (size_t p = begin; p < end; p++) {
+                        result.distances[p * result.gamutCount + g] =
+                            gamut.signedDistance(points[p], (result.masks[p] >> g) & 1u);
+                    }
+                }
+            }
+        });
+        timer.stop(fmt::format("({} points, {} gamuts)", points.size(), result.gamutCount));
+        return result;
+    }
+
+    std::vector<Vector3f> read(const fs::path& path)
+    {
+        std::vector<Vector3f> result;
+        if (path.extension() == ".lab") {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            $assert(file.is_open(), "Failed to open {}", path.string());
+            result.resize((size_t)file.tellg() / sizeof(Vector3f));
+            file.seekg(0);
+            file.read((char*)result.data(), result.size() * sizeof(Vector3f));
+            return result;
+        }
+
+        std::ifstream file(path);
+        $assert(file.is_open(), "Failed to open {}", path.string());
+        std::string line;
+        size_t skipped = 0u;
+        while (std::getline(file, line)) {
+            std::replace_if(
+                line.begin(), line.end(), [](char c) { return c == ',' || c == ';'; }, ' '
+            );
+            std::stringstream ss(line);
+            Vector3f lab;
+            if (ss >> lab.x() >> lab.y() >> lab.z()) {
+                result.push_back(lab);
+            } else if (!line.empty()) {
+                skipped++;
+            }
+        }
+        $info("Read {} points from {}, skipped {} lines", result.size(), path.string(), skipped);
+        return result;
+    }
+
+    void writeCsv(
+        const fs::path& path,
+        const std::vector<Vector3f>& points,
+        const std::vector<std::shared_ptr<Gamut::GamutMesh>>& gamuts,
+        const Classification& result
+    )
+    {
+        std::ofstream file(path);
+        $assert(file.is_open(), "Failed to open {} for writing", path.string());
+        file << "L,a,b,mask";
+        if (!result.distances.empty()) {
+            for (size_t g = 0; g < result.gamutCount; g++) {
+                file << ",\"" << gamuts[g]->label << '"';
+            }
+        }
+        file << '\n';
+        for (size_t p = 0; p < points.size(); p++) {
+            file << fmt::format(
+                "{:.4f},{:.4f},{:.4f},{}", points[p].x(), points[p].y(), points[p].z(),
+                result.masks[p]
+            );
+            if (!result.distances.empty()) {
+                for (size_t g = 0; g < result.gamutCount; g++) {
+                    file << fmt::format(",{:.4f}", result.distance(p, g));
+                }
+            }
+            file << '\n';
+        }
+        $info("Wrote classification of {} points to {}", points.size(), path.string());
+    }
+}
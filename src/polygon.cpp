@@ -0,0 +1,184 @@
+#include <polygon.hpp>
+
+namespace
+{
+    // Average number of edges per band
+    constexpr size_t edgesPerBand = 4u;
+    constexpr size_t maxBands = 1024u;
+    // Boundary tolerance relative to the region's extent
+    constexpr double relativeTolerance = 1e-7;
+
+    double cross(const Vector2d& a, const Vector2d& b)
+    {
+        return a.x() * b.y() - a.y() * b.x();
+    }
+}
+
+namespace polygon
+{
+    Region::Region(const std::vector<Loop>& loops)
+    {
+        Vector2d lower = Vector2d::Constant(std::numeric_limits<double>::max());
+        Vector2d upper = Vector2d::Constant(std::numeric_limits<double>::lowest());
+        for (const Loop& loop : loops) {
+            for (size_t i = 0; i < loop.size(); i++) {
+                const Vector2d from = loop[i].cast<double>();
+                const Vector2d to = loop[(i + 1) % loop.size()].cast<double>();
+                if (from != to) {
+                    this->edges.push_back({ from, to });
+                    lower = lower.cwiseMin(from);
+                    upper = upper.cwiseMax(from);
+                }
+            }
+        }
+        if (this->edges.empty()) {
+            return;
+        }
+        // Slices follow the winding of their mesh, an outward-wound mesh gives clockwise outlines
+        // and counter-clockwise holes. Their total is negative then and every edge turns around.
+        if (this->area() < 0.0) {
+            for (Edge& edge : this->edges) {
+                std::swap(edge.from, edge.to);
+            }
+        }
+        this->tolerance = relativeTolerance * std::max((upper - lower).maxCoeff(), 1.0);
+        const size_t count = std::clamp(this->edges.size() / edgesPerBand, size_t(1), maxBands);
+        this->lo = lower.y();
+        this->bandHeight = std::max(upper.y() - lower.y(), this->tolerance) / count;
+
+        // Counting sort of the edges into every band their y range overlaps
+        this->bandStarts.assign(count + 1u, 0u);
+        for (const Edge& edge : this->edges) {
+            const auto [first, last] = this->bands(
+                std::min(edge.from.y(), edge.to.y()), std::max(edge.from.y(), edge.to.y())
+            );
+            for (size_t b = first; b < last; b++) {
+                this->bandStarts[b + 1u]++;
+            }
+        }
+        for (size_t b = 0; b < count; b++) {
+            this->bandStarts[b + 1u] += this->bandStarts[b];
+        }
+        this->bandEdges.resize(this->bandStarts.back());
+        std::vector<uint32_t> fill(this->bandStarts.begin(), this->bandStarts.end() - 1);
+        for (uint32_t e = 0; e < this->edges.size(); e++) {
+            const Edge& edge = this->edges[e];
+            const auto [first, last] = this->bands(
+                std::min(edge.from.y(), edge.to.y()), std::max(edge.from.y(), edge.to.y())
+            );
+            for (size_t b = first; b < last; b++) {
+                this->bandEdges[fill[b]++] = e;
+            }
+        }
+    }
+
+    double Region::area() const
+    {
+        double sum = 0.0;
+        for (const Edge& edge : this->edges) {
+            sum += cross(edge.from, edge.to);
+        }
+        return sum / 2.0;
+    }
+
+    std::pair<size_t, size_t> Region::bands(double y0, double y1) const
+    {
+        const size_t count = this->bandStarts.size() - 1u;
+        // Widened by the tolerance so points on a band border see the edges of both bands
+        const double first = std::floor((y0 - this->tolerance - this->lo) / this->bandHeight);
+        const double last = std::floor((y1 + this->tolerance - this->lo) / this->bandHeight);
+        if (last < 0.0 || first >= (double)count) {
+            return { 0u, 0u };
+        }
+        return { (size_t)std::max(first, 0.0), std::min((size_t)last + 1u, count) };
+    }
+
+    Region::Side Region::side(const Vector2d& p, const Vector2d& direction) const
+    {
+        const auto [first, last] = this->bands(p.y(), p.y());
+        if (first == last) {
+            return Side::outside;
+        }
+        // Only edges of one band are needed, which avoids counting an edge twice
+        const size_t band = std::clamp(
+            (size_t)std::max(std::floor((p.y() - this->lo) / this->bandHeight), 0.0), first,
+            last - 1u
+        );
+        int winding = 0;
+        for (uint32_t i = this->bandStarts[band]; i < this->bandStarts[band + 1u]; i++) {
+            const Edge& edge = this->edges[this->bandEdges[i]];
+            const Vector2d d = edge.to - edge.from;
+            const double length = d.norm();
+            const double along = (p - edge.from).dot(d) / (length * length);
+            if (std::abs(cross(d, p - edge.from)) <= this->tolerance * length &&
+                along >= 0.0 && along <= 1.0) {
+                return d.dot(direction) >= 0.0 ? Side::alongBoundary : Side::againstBoundary;
+            }
+            // Half-open in y, so a ray through a shared vertex counts it once
+            const bool upward = edge.from.y() <= p.y() && p.y() < edge.to.y();
+            const bool downward = edge.to.y() <= p.y() && p.y() < edge.from.y();
+            if ((upward || downward) && (cross(d, p - edge.from) > 0.0) == upward) {
+                winding += upward ? 1 : -1;
+            }
+        }
+        return winding != 0 ? Side::inside : Side::outside;
+    }
+
+    double Region::boundaryInside(const Region& other, bool countShared) const
+    {
+        double sum = 0.0;
+        std::vector<double> splits;
+        for (const Edge& edge : this->edges) {
+            const Vector2d d = edge.to - edge.from;
+            const double lengthSq = d.squaredNorm();
+            splits.assign({ 0.0, 1.0 });
+            const auto [first, last] = other.bands(
+                std::min(edge.from.y(), edge.to.y()), std::max(edge.from.y(), edge.to.y())
+            );
+            for (uint32_t i = other.bandStarts[first]; i < other.bandStarts[last]; i++) {
+                const Edge& cut = other.edges[other.bandEdges[i]];
+                const Vector2d e = cut.to - cut.from;
+                const double denominator = cross(d, e);
+                if (std::abs(denominator) > this->tolerance * std::sqrt(lengthSq) * e.norm()) {
+                    const Vector2d w = cut.from - edge.from;
+                    const double t = cross(w, e) / denominator;
+                    const double u = cross(w, d) / denominator;
+                    if (t > 0.0 && t < 1.0 && u >= 0.0 && u <= 1.0) {
+                        splits.push_back(t);
+                    }
+                }
+                // Endpoints touching the edge split it too, covering collinear overlaps
+                for (const Vector2d& end : { cut.from, cut.to }) {
+                    const double t = (end - edge.from).dot(d) / lengthSq;
+                    if (t > 0.0 && t < 1.0 && (edge.from + t * d - end).norm() <= other.tolerance) {
+                        splits.push_back(t);
+                    }
+                }
+            }
+            std::sort(splits.begin(), splits.end());
+
+            // Bands may repeat an edge, repeated splits only produce empty pieces
+            for (size_t s = 0; s + 1u < splits.size(); s++) {
+                if (splits[s + 1u] <= splits[s]) {
+                    continue;
+                }
+                const Vector2d from = edge.from + splits[s] * d;
+                const Vector2d to = edge.from + splits[s + 1u] * d;
+                const Side side = other.side((from + to) / 2.0, d);
+                if (side == Side::inside || (countShared && side == Side::alongBoundary)) {
+                    // Twice the area swept by the piece as seen from the origin
+                    sum += cross(from, to);
+                }
+            }
+        }
+        return sum / 2.0;
+    }
+
+    double intersectionArea(const Region& a, const Region& b)
+    {
+        if (a.empty() || b.empty()) {
+            return 0.0;
+        }
+        return a.boundaryInside(b, true) + b.boundaryInside(a, false);
+    }
+}
@@ -0,0 +1,105 @@
+#include <remesh.hpp>
+#include <fstream>
+
+namespace
+{
+    constexpr char binaryMagic[4] = { 'R', 'M', 'S', 'H' };
+    constexpr uint32_t binaryVersion = 2u;
+
+    template <typename T> void writeValue(std::ofstream& file, const T& value)
+    {
+        file.write((const char*)&value, sizeof(T));
+    }
+
+    template <typename T> T readValue(std::ifstream& file)
+    {
+        T value{};
+        file.read((char*)&value, sizeof(T));
+        return value;
+    }
+}
+
+csg::Geometry remesh::isotropic(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles,
+    float targetEdgeLength,
+    int iterations
+)
+{
+    SurfaceMesh mesh;
+    std::vector<Point3> points(vertices.size());
+    std::transform(vertices.begin(), vertices.end(), points.begin(), [](const Vector3f& v) {
+        return Point3(v.x(), v.y(), v.z());
+    });
+    PMP::polygon_soup_to_polygon_mesh(points, triangles, mesh);
+
+    // Splitting the slivers up front keeps the first iteration from working on huge edges
+    PMP::split_long_edges(edges(mesh), targetEdgeLength, mesh);
+    PMP::isotropic_remeshing(
+        faces(mesh), targetEdgeLength, mesh,
+        CGAL::parameters::number_of_iterations(iterations).protect_constraints(false)
+    );
+    mesh.collect_garbage();
+    return csg::toGeometry(mesh);
+}
+
+fs::path remesh::cachePath(const fs::path& source)
+{
+    return source.string() + ".remesh";
+}
+
+std::optional<csg::Geometry> remesh::readCache(
+    const fs::path& path,
+    uint64_t sourceHash,
+    float targetEdgeLength
+)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return std::nullopt;
+    }
+    char magic[4];
+    file.read(magic, sizeof(magic));
+    if (!std::equal(magic, magic + 4, binaryMagic) || readValue<uint32_t>(file) != binaryVersion) {
+        $warn("{} is not a remesh cache file", path.string());
+        return std::nullopt;
+    }
+    if (readValue<uint32_t>(file) != Mesh::contentHashVersion ||
+        readValue<uint64_t>(file) != sourceHash || readValue<float>(file) != targetEdgeLength) {
+        $debug("{} was made from other content or edge length", path.string());
+        return std::nullopt;
+    }
+    csg::Geometry geom;
+    geom.vertices.resize(readValue<uint64_t>(file));
+    geom.triangles.resize(readValue<uint64_t>(file));
+    file.read((char*)geom.vertices.data(), geom.vertices.size() * sizeof(Vector3f));
+    file.read((char*)geom.triangles.data(), geom.triangles.size() * sizeof(Vector3u));
+    if (!file) {
+        $warn("{} is truncated", path.string());
+        return std::nullopt;
+    }
+    return geom;
+}
+
+void remesh::writeCache(
+    const fs::path& path,
+    uint64_t sourceHash,
+    float targetEdgeLength,
+    const csg::Geometry& geom
+)
+{
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        $warn("Failed to open {} for writing", path.string());
+        return;
+    }
+    file.write(binaryMagic, sizeof(binaryMagic));
+    writeValue(file, binaryVersion);
+    writeValue(file, Mesh::contentHashVersion);
+    writeValue(file, sourceHash);
+    writeValue(file, targetEdgeLength);
+    writeValue(file, (uint64_t)geom.vertices.size());
+    writeValue(file, (uint64_t)geom.triangles.size());
+    file.write((const char*)geom.vertices.data(), geom.vertices.size() * sizeof(Vector3f));
+    file.write((const char*)geom.triangles.data(), geom.triangles.size() * sizeof(Vector3u));
+}
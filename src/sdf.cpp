@@ -0,0 +1,273 @@
+#include <sdf.hpp>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    // Freudenthal split of a cube into six tetrahedra around its main diagonal, corners are
+    // numbered x + 2y + 4z. Every cube is split the same way so neighboring faces match up.
+    constexpr int cubeTetrahedra[6][4] = { { 0, 1, 3, 7 }, { 0, 3, 2, 7 }, { 0, 2, 6, 7 },
+                                           { 0, 6, 4, 7 }, { 0, 4, 5, 7 }, { 0, 5, 1, 7 } };
+
+    // Surface vertices and triangles produced by one slab of cells
+    struct Slab
+    {
+        // Lattice edge each vertex was placed on, used to weld slabs together
+        std::vector<uint64_t> edges;
+        std::vector<Vector3f> vertices;
+        std::vector<Vector3u> triangles;
+    };
+
+    float cross2(const Vector2f& a, const Vector2f& b)
+    {
+        return a.x() * b.y() - a.y() * b.x();
+    }
+
+    // Lattice range (inclusive) of points within pad cells of the given bounds
+    std::pair<Vector3i, Vector3i> latticeRange(
+        const SdfGrid& grid,
+        const Vector3f& lo,
+        const Vector3f& hi,
+        float pad
+    )
+    {
+        const Vector3f a = ((lo - grid.origin) / grid.cellSize).array() - pad;
+        const Vector3f b = ((hi - grid.origin) / grid.cellSize).array() + pad;
+        return { a.array().floor().cast<int>().max(0).matrix(),
+                 b.array().ceil().cast<int>().min(grid.dims.array() - 1).matrix() };
+    }
+}
+
+SdfGrid::SdfGrid(const Vector3f& bbMin, const Vector3f& bbMax, float _cellSize, int _band)
+    : cellSize(_cellSize), band(_band)
+{
+    this->origin = bbMin.array() - this->cellSize * this->band;
+    this->dims = (((bbMax - bbMin) / this->cellSize).array().ceil().cast<int>() + 2 * band + 1);
+    this->values.assign(this->dims.prod(), this->cellSize * this->band);
+}
+
+void SdfGrid::rasterize(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+)
+{
+    const float bandDist = this->cellSize * this->band;
+    std::fill(this->values.begin(), this->values.end(), bandDist);
+
+    // Bin triangles by the z layers they can affect and by the x rows that can cross them
+    std::vector<std::vector<uint32_t>> layers(this->dims.z());
+    std::vector<std::vector<uint32_t>> rows((size_t)this->dims.y() * this->dims.z());
+    for (uint32_t t = 0; t < triangles.size(); t++) {
+        const Vector3f& a = vertices[triangles[t].x()];
+        const Vector3f& b = vertices[triangles[t].y()];
+        const Vector3f& c = vertices[triangles[t].z()];
+        const Vector3f lo = a.cwiseMin(b).cwiseMin(c);
+        const Vector3f hi = a.cwiseMax(b).cwiseMax(c);
+        const auto [bandLo, bandHi] = latticeRange(*this, lo, hi, (float)this->band);
+        for (int z = bandLo.z(); z <= bandHi.z(); z++) {
+            layers[z].push_back(t);
+        }
+        const auto [rowLo, rowHi] = latticeRange(*this, lo, hi, 0.0f);
+        for (int z = rowLo.z(); z <= rowHi.z(); z++) {
+            for (int y = rowLo.y(); y <= rowHi.y(); y++) {
+                rows[y + (size_t)this->dims.y() * z].push_back(t);
+            }
+        }
+    }
+
+    // Unsigned distance in the narrow band, each task owns one z layer
+    std::vector<int> layerIndices(this->dims.z());
+    std::iota(layerIndices.begin(), layerIndices.end(), 0);
+    std::for_each(std::execution::par, layerIndices.begin(), layerIndices.end(), [&](int z) {
+        for (uint32_t t : layers[z]) {
+            const Triangle tri({ vertices[triangles[t].x()], vertices[triangles[t].y()],
+                                 vertices[triangles[t].z()] });
+            const Vector3f lo = tri.verts[0].cwiseMin(tri.verts[1]).cwiseMin(tri.verts[2]);
+            const Vector3f hi = tri.verts[0].cwiseMax(tri.verts[1]).cwiseMax(tri.verts[2]);
+            const auto [rangeLo, rangeHi] = latticeRange(*this, lo, hi, (float)this->band);
+            for (int y = rangeLo.y(); y <= rangeHi.y(); y++) {
+                for (int x = rangeLo.x(); x <= rangeHi.x(); x++) {
+                    const Vector3f p = this->point(x, y, z);
+                    float& value = this->values[this->index(x, y, z)];
+                    value = std::min(value, (closestPoint(tri, p) - p).norm());
+                }
+            }
+        }
+    });
+
+    // Sign from the parity of surface crossings along each x row. Rows are nudged off the
+    // lattice so they do not pass exactly through mesh edges.
+    const Vector2f nudge = Vector2f(1.3e-3f, 1.7e-3f) * this->cellSize;
+    std::vector<int> rowIndices(rows.size());
+    std::iota(rowIndices.begin(), rowIndices.end(), 0);
+    std::for_each(std::execution::par, rowIndices.begin(), rowIndices.end(), [&](int r) {
+        const int y = r % this->dims.y();
+        const int z = r / this->dims.y();
+        const Vector2f p = this->point(0, y, z).tail<2>() + nudge;
+        std::vector<float> hits;
+        for (uint32_t t : rows[r]) {
+            const Vector3f& a = vertices[triangles[t].x()];
+            const Vector3f& b = vertices[triangles[t].y()];
+            const Vector3f& c = vertices[triangles[t].z()];
+            const Vector2f a2 = a.tail<2>(), b2 = b.tail<2>(), c2 = c.tail<2>();
+            const float area = cross2(b2 - a2, c2 - a2);
+            if (std::abs(area) <= std::numeric_limits<float>::epsilon()) {
+                continue;
+            }
+            const float la = cross2(c2 - b2, p - b2) / area;
+            const float lb = cross2(a2 - c2, p - c2) / area;
+            const float lc = 1.0f - la - lb;
+            if (la >= 0.0f && lb >= 0.0f && lc >= 0.0f) {
+                hits.push_back(la * a.x() + lb * b.x() + lc * c.x());
+            }
+        }
+        std::sort(hits.begin(), hits.end());
+        bool inside = false;
+        size_t h = 0u;
+        for (int x = 0; x < this->dims.x(); x++) {
+            const float px = this->origin.x() + x * this->cellSize;
+            for (; h < hits.size() && hits[h] < px; h++) {
+                inside = !inside;
+            }
+            if (inside) {
+                float& value = this->values[this->index(x, y, z)];
+                value = -value;
+            }
+        }
+    });
+}
+
+void SdfGrid::combine(const SdfGrid& other, Op op)
+{
+    $assert(this->dims == other.dims, "Combined grids must share a lattice");
+    std::transform(
+        std::execution::par_unseq, this->values.begin(), this->values.end(), other.values.begin(),
+        this->values.begin(),
+        [op](float a, float b) {
+            switch (op) {
+                case Op::intersect:
+                    return std::max(a, b);
+                case Op::unite:
+                    return std::min(a, b);
+                case Op::subtract:
+                    return std::max(a, -b);
+            }
+            return a;
+        }
+    );
+}
+
+csg::Geometry SdfGrid::extract() const
+{
+    // Each task marches one slab of cells between two z layers
+    std::vector<Slab> slabs(std::max(this->dims.z() - 1, 0));
+    std::vector<int> slabIndices(slabs.size());
+    std::iota(slabIndices.begin(), slabIndices.end(), 0);
+    std::for_each(std::execution::par, slabIndices.begin(), slabIndices.end(), [&](int z) {
+        Slab& slab = slabs[z];
+        std::unordered_map<uint64_t, uint32_t> edgeVertices;
+        // Vertex on the lattice edge from corner a to corner b of the cell at (x, y, z)
+        const auto edgeVertex = [&](const Vector3i& cell, int a, int b) {
+            // Tetrahedron edges join a corner to one whose bits are a superset of its own, start
+            // from the lower one so neighboring cells produce the same key and position
+            if ((a & b) != a) {
+                std::swap(a, b);
+            }
+            const Vector3i pa = cell + Vector3i(a & 1, (a >> 1) & 1, (a >> 2) & 1);
+            const Vector3i pb = cell + Vector3i(b & 1, (b >> 1) & 1, (b >> 2) & 1);
+            const uint64_t key = this->index(pa.x(), pa.y(), pa.z()) * 8u + (a ^ b);
+            auto [it, inserted] = edgeVertices.try_emplace(key, (uint32_t)slab.vertices.size());
+            if (inserted) {
+                const float da = this->values[this->index(pa.x(), pa.y(), pa.z())];
+                const float db = this->values[this->index(pb.x(), pb.y(), pb.z())];
+                const Vector3f va = this->point(pa.x(), pa.y(), pa.z());
+                const Vector3f vb = this->point(pb.x(), pb.y(), pb.z());
+                slab.vertices.push_back(va + (vb - va) * (da / (da - db)));
+                slab.edges.push_back(key);
+            }
+            return it->second;
+        };
+        // Emits a triangle facing away from the inside corners
+        const auto emit = [&](Vector3u tri, const Vector3f& outward) {
+            const Vector3f& v0 = slab.vertices[tri.x()];
+            const Vector3f n = (slab.vertices[tri.y()] - v0).cross(slab.vertices[tri.z()] - v0);
+            if (n.dot(outward) < 0.0f) {
+                std::swap(tri.y(), tri.z());
+            }
+            slab.triangles.push_back(tri);
+        };
+
+        for (int y = 0; y + 1 < this->dims.y(); y++) {
+            for (int x = 0; x + 1 < this->dims.x(); x++) {
+                const Vector3i cell(x, y, z);
+                float d[8];
+                uint8_t insideMask = 0u;
+                for (int c = 0; c < 8; c++) {
+                    const Vector3i p = cell + Vector3i(c & 1, (c >> 1) & 1, c >> 2);
+                    d[c] = this->values[this->index(p.x(), p.y(), p.z())];
+                    insideMask |= (d[c] < 0.0f) << c;
+                }
+                if (insideMask == 0u || insideMask == 0xFFu) {
+                    continue;
+                }
+                for (const auto& tet : cubeTetrahedra) {
+                    int in[4], out[4];
+                    int nIn = 0, nOut = 0;
+                    Vector3f inCenter = Vector3f::Zero(), outCenter = Vector3f::Zero();
+                    for (int c : tet) {
+                        const Vector3f p(c & 1, (c >> 1) & 1, c >> 2);
+                        if (d[c] < 0.0f) {
+                            in[nIn++] = c;
+                            inCenter += p;
+                        } else {
+                            out[nOut++] = c;
+                            outCenter += p;
+                        }
+                    }
+                    if (nIn == 0 || nOut == 0) {
+                        continue;
+                    }
+                    const Vector3f outward = outCenter / nOut - inCenter / nIn;
+                    if (nIn == 1 || nOut == 1) {
+                        // A single corner is cut off by one triangle
+                        const bool loneIn = nIn == 1;
+                        const int lone = loneIn ? in[0] : out[0];
+                        const int* others = loneIn ? out : in;
+                        emit(
+                            { edgeVertex(cell, lone, others[0]), edgeVertex(cell, lone, others[1]),
+                              edgeVertex(cell, lone, others[2]) },
+                            outward
+                        );
+                    } else {
+                        // Two corners on each side are separated by a quad
+                        const uint32_t q0 = edgeVertex(cell, in[0], out[0]);
+                        const uint32_t q1 = edgeVertex(cell, in[0], out[1]);
+                        const uint32_t q2 = edgeVertex(cell, in[1], out[1]);
+                        const uint32_t q3 = edgeVertex(cell, in[1], out[0]);
+                        emit({ q0, q1, q2 }, outward);
+                        emit({ q0, q2, q3 }, outward);
+                    }
+                }
+            }
+        }
+    });
+
+    // Weld slabs, vertices on shared z layers appear in both neighbors
+    csg::Geometry geom;
+    std::unordered_map<uint64_t, uint32_t> edgeVertices;
+    for (const Slab& slab : slabs) {
+        std::vector<uint32_t> remap(slab.vertices.size());
+        for (size_t i = 0; i < slab.vertices.size(); i++) {
+            auto [it, inserted] =
+                edgeVertices.try_emplace(slab.edges[i], (uint32_t)geom.vertices.size());
+            if (inserted) {
+                geom.vertices.push_back(slab.vertices[i]);
+            }
+            remap[i] = it->second;
+        }
+        for (const Vector3u& t : slab.triangles) {
+            geom.triangles.push_back({ remap[t.x()], remap[t.y()], remap[t.z()] });
+        }
+    }
+    return geom;
+}
@@ -0,0 +1,136 @@
+#include <slice.hpp>
+
+namespace
+{
+    // Average number of triangles per bin, bins are narrow enough that most of a bin's
+    // triangles cross any plane inside it
+    constexpr size_t trianglesPerBin = 8u;
+    constexpr size_t maxBins = 4096u;
+
+    using EdgeKey = UnorderedPair<uint64_t>;
+}
+
+LightnessSlicer::LightnessSlicer(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+)
+{
+    if (triangles.empty()) {
+        return;
+    }
+    float hi = std::numeric_limits<float>::lowest();
+    this->lo = std::numeric_limits<float>::max();
+    for (const Vector3f& v : vertices) {
+        this->lo = std::min(this->lo, v.x());
+        hi = std::max(hi, v.x());
+    }
+    const size_t bins = std::clamp(triangles.size() / trianglesPerBin, size_t(1), maxBins);
+    this->binWidth = std::max(hi - this->lo, std::numeric_limits<float>::epsilon()) / bins;
+
+    // Bin range of every triangle, then counting sort into the bins
+    const auto binOf = [&](float lightness) {
+        return std::min((size_t)((lightness - this->lo) / this->binWidth), bins - 1u);
+    };
+    std::vector<std::pair<uint32_t, uint32_t>> ranges(triangles.size());
+    this->binStarts.assign(bins + 1u, 0u);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        const float l0 = vertices[triangles[t].x()].x();
+        const float l1 = vertices[triangles[t].y()].x();
+        const float l2 = vertices[triangles[t].z()].x();
+        ranges[t] = { (uint32_t)binOf(std::min({ l0, l1, l2 })),
+                      (uint32_t)binOf(std::max({ l0, l1, l2 })) };
+        for (uint32_t b = ranges[t].first; b <= ranges[t].second; b++) {
+            this->binStarts[b + 1u]++;
+        }
+    }
+    for (size_t b = 0; b < bins; b++) {
+        this->binStarts[b + 1u] += this->binStarts[b];
+    }
+    this->binTriangles.resize(this->binStarts.back());
+    std::vector<uint32_t> fill(this->binStarts.begin(), this->binStarts.end() - 1);
+    for (size_t t = 0; t < triangles.size(); t++) {
+        for (uint32_t b = ranges[t].first; b <= ranges[t].second; b++) {
+            this->binTriangles[fill[b]++] = (uint32_t)t;
+        }
+    }
+}
+
+std::vector<LightnessSlicer::Polygon> LightnessSlicer::slice(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles,
+    float lightness
+) const
+{
+    if (this->binStarts.empty()) {
+        return {};
+    }
+    const float offset = (lightness - this->lo) / this->binWidth;
+    if (offset < 0.0f || offset >= (float)(this->binStarts.size() - 1u)) {
+        return {};
+    }
+    const size_t bin = (size_t)offset;
+
+    // Each crossed triangle contributes a segment from the edge where the surface rises through
+    // the plane to the edge where it falls back, so segments of neighbors chain head to tail.
+    // Vertices exactly on the plane count as above it, which keeps every crossing on an edge.
+    std::unordered_map<EdgeKey, EdgeKey> next;
+    std::unordered_map<EdgeKey, Vector2f> points;
+    const auto crossing = [&](uint32_t a, uint32_t b) {
+        const EdgeKey key(a, b);
+        if (!points.contains(key)) {
+            // Interpolate from the lower index so both triangles sharing the edge agree
+            const Vector3f& p = vertices[key.min()];
+            const Vector3f& q = vertices[key.max()];
+            const float t = (lightness - p.x()) / (q.x() - p.x());
+            points[key] = lerp(Vector2f(p.tail<2>()), Vector2f(q.tail<2>()), t);
+        }
+        return key;
+    };
+    for (uint32_t i = this->binStarts[bin]; i < this->binStarts[bin + 1u]; i++) {
+        const Vector3u& t = triangles[this->binTriangles[i]];
+        std::optional<EdgeKey> rise, fall;
+        for (int c = 0; c < 3; c++) {
+            const uint32_t a = t[c], b = t[(c + 1) % 3];
+            const bool aboveA = vertices[a].x() >= lightness;
+            const bool aboveB = vertices[b].x() >= lightness;
+            if (!aboveA && aboveB) {
+                rise = crossing(a, b);
+            } else if (aboveA && !aboveB) {
+                fall = crossing(a, b);
+            }
+        }
+        if (rise && fall) {
+            next[*rise] = *fall;
+        }
+    }
+
+    std::vector<Polygon> loops;
+    std::unordered_set<EdgeKey> visited;
+    size_t openChains = 0u;
+    for (const auto& [start, unused] : next) {
+        if (visited.contains(start)) {
+            continue;
+        }
+        Polygon loop;
+        EdgeKey key = start;
+        bool closed = false;
+        while (visited.insert(key).second) {
+            loop.push_back(points[key]);
+            const auto it = next.find(key);
+            if (it == next.end()) {
+                break;
+            }
+            key = it->second;
+            closed = key == start;
+        }
+        if (closed) {
+            loops.push_back(std::move(loop));
+        } else {
+            openChains++;
+        }
+    }
+    if (openChains) {
+        $debug("Dropped {} open chains slicing at L* {:.1f}", openChains, lightness);
+    }
+    return loops;
+}
@@ -0,0 +1,200 @@
+#include <spherical.hpp>
+#include <bvh.hpp>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    // Sideways offset of retried rays, in radians
+    constexpr float nudge = 1e-4f;
+
+    // Subdivides every triangle into four, the new corners are edge midpoints pushed out to the
+    // unit sphere and shared by the two triangles of their edge
+    void subdivide(spherical::Icosphere& sphere)
+    {
+        std::unordered_map<uint64_t, uint32_t> midpoints;
+        const auto midpoint = [&](uint32_t a, uint32_t b) {
+            const uint64_t key = ((uint64_t)std::min(a, b) << 32) | std::max(a, b);
+            auto [it, inserted] = midpoints.try_emplace(key, (uint32_t)sphere.directions.size());
+            if (inserted) {
+                sphere.directions.push_back(
+                    (sphere.directions[a] + sphere.directions[b]).normalized()
+                );
+            }
+            return it->second;
+        };
+        std::vector<Vector3u> triangles;
+        triangles.reserve(sphere.triangles.size() * 4u);
+        for (const Vector3u& t : sphere.triangles) {
+            const uint32_t ab = midpoint(t.x(), t.y());
+            const uint32_t bc = midpoint(t.y(), t.z());
+            const uint32_t ca = midpoint(t.z(), t.x());
+            triangles.push_back({ t.x(), ab, ca });
+            triangles.push_back({ t.y(), bc, ab });
+            triangles.push_back({ t.z(), ca, bc });
+            triangles.push_back({ ab, bc, ca });
+        }
+        sphere.triangles = std::move(triangles);
+        sphere.subdivisions++;
+    }
+}
+
+namespace spherical
+{
+    const Icosphere& icosphere(uint32_t subdivisions)
+    {
+        static std::mutex mutex;
+        static std::unordered_map<uint32_t, std::unique_ptr<Icosphere>> spheres;
+        std::scoped_lock lock(mutex);
+        std::unique_ptr<Icosphere>& sphere = spheres[subdivisions];
+        if (sphere) {
+            return *sphere;
+        }
+
+        // Icosahedron with outward counter-clockwise faces
+        const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+        sphere = std::make_unique<Icosphere>();
+        sphere->directions = {
+            { -1.0f, t, 0.0f },  { 1.0f, t, 0.0f },  { -1.0f, -t, 0.0f }, { 1.0f, -t, 0.0f },
+            { 0.0f, -1.0f, t },  { 0.0f, 1.0f, t },  { 0.0f, -1.0f, -t }, { 0.0f, 1.0f, -t },
+            { t, 0.0f, -1.0f },  { t, 0.0f, 1.0f },  { -t, 0.0f, -1.0f }, { -t, 0.0f, 1.0f },
+        };
+        for (Vector3f& d : sphere->directions) {
+            d.normalize();
+        }
+        sphere->triangles = {
+            { 0, 11, 5 }, { 0, 5, 1 },  { 0, 1, 7 },   { 0, 7, 10 }, { 0, 10, 11 },
+            { 1, 5, 9 },  { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+            { 3, 9, 4 },  { 3, 4, 2 },  { 3, 2, 6 },   { 3, 6, 8 },  { 3, 8, 9 },
+            { 4, 9, 5 },  { 2, 4, 11 }, { 6, 2, 10 },  { 8, 6, 7 },  { 9, 8, 1 },
+        };
+        while (sphere->subdivisions < subdivisions) {
+            subdivide(*sphere);
+        }
+        $debug(
+            "built icosphere with {} subdivisions, {} vertices", subdivisions,
+            sphere->directions.size()
+        );
+        return *sphere;
+    }
+
+    std::shared_ptr<SharedIndexBuffer> indexBuffer(uint32_t subdivisions)
+    {
+        static std::mutex mutex;
+        static std::unordered_map<uint32_t, std::weak_ptr<SharedIndexBuffer>> buffers;
+        std::scoped_lock lock(mutex);
+        std::shared_ptr<SharedIndexBuffer> buffer = buffers[subdivisions].lock();
+        if (!buffer) {
+            buffer = std::make_shared<SharedIndexBuffer>();
+            buffers[subdivisions] = buffer;
+        }
+        return buffer;
+    }
+
+    Sampling resample(
+        const std::vector<Vector3f>& vertices,
+        const std::vector<Vector3u>& triangles,
+        const Vector3f& center,
+        uint32_t subdivisions
+    )
+    {
+        const Icosphere& sphere = icosphere(subdivisions);
+        Sampling result;
+        result.subdivisions = subdivisions;
+        result.center = center;
+        if (triangles.empty()) {
+            return result;
+        }
+        Bvh bvh;
+        bvh.build(vertices, triangles);
+        // Rays start beyond the farthest vertex so their first hit is the outermost layer
+        float reach = 0.0f;
+        for (const Vector3f& v : vertices) {
+            reach = std::max(reach, (v - center).norm());
+        }
+        reach += 1.0f;
+
+        result.radii.resize(sphere.directions.size());
+        std::transform(
+            std::execution::par, sphere.directions.begin(), sphere.directions.end(),
+            result.radii.begin(),
+            [&](const Vector3f& d) {
+                // Rays through a vertex or along an edge can slip between the triangles' tests
+                // and only hit the far side past the center, those are retried slightly off to
+                // the side
+                const Vector3f u = d.unitOrthogonal(), v = d.cross(u);
+                for (const Vector3f& offset : { Vector3f::Zero().eval(), Vector3f(nudge * u),
+                                                Vector3f(nudge * v) }) {
+                    const Vector3f direction = (d + offset).normalized();
+                    const std::optional<Bvh::Hit> hit =
+                        bvh.intersect(Ray(center + reach * direction, -direction));
+                    if (hit && hit->distance <= reach) {
+                        return reach - hit->distance;
+                    }
+                }
+                return 0.0f;
+            }
+        );
+        result.points.resize(sphere.directions.size());
+        std::transform(
+            std::execution::par, sphere.directions.begin(), sphere.directions.end(),
+            result.radii.begin(), result.points.begin(),
+            [&](const Vector3f& d, float r) { return Vector3f(center + r * d); }
+        );
+        return result;
+    }
+
+    std::vector<Vector3f> difference(const Sampling& a, const Sampling& b)
+    {
+        $assert(a.subdivisions == b.subdivisions, "Samplings have different topologies");
+        std::vector<Vector3f> result(a.points.size());
+        std::transform(
+            std::execution::par, a.points.begin(), a.points.end(), b.points.begin(),
+            result.begin(), [](const Vector3f& p, const Vector3f& q) { return Vector3f(q - p); }
+        );
+        return result;
+    }
+
+    std::vector<Vector3f> morph(const Sampling& a, const Sampling& b, float t)
+    {
+        $assert(a.subdivisions == b.subdivisions, "Samplings have different topologies");
+        std::vector<Vector3f> result(a.points.size());
+        std::transform(
+            std::execution::par, a.points.begin(), a.points.end(), b.points.begin(),
+            result.begin(), [&](const Vector3f& p, const Vector3f& q) { return lerp(p, q, t); }
+        );
+        return result;
+    }
+
+    Statistics statistics(const std::vector<const Sampling*>& samplings)
+    {
+        Statistics result;
+        if (samplings.empty()) {
+            return result;
+        }
+        for (const Sampling* s : samplings) {
+            $assert(
+                s->subdivisions == samplings[0]->subdivisions, "Samplings have different topologies"
+            );
+        }
+        const size_t n = samplings[0]->points.size();
+        result.mean.resize(n);
+        result.deviation.resize(n);
+        std::vector<size_t> indices(n);
+        std::iota(indices.begin(), indices.end(), 0u);
+        std::for_each(std::execution::par, indices.begin(), indices.end(), [&](size_t i) {
+            Vector3f mean = Vector3f::Zero();
+            for (const Sampling* s : samplings) {
+                mean += s->points[i];
+            }
+            mean /= (float)samplings.size();
+            float variance = 0.0f;
+            for (const Sampling* s : samplings) {
+                variance += (s->points[i] - mean).squaredNorm();
+            }
+            result.mean[i] = mean;
+            result.deviation[i] = std::sqrt(variance / (float)samplings.size());
+        });
+        return result;
+    }
+}
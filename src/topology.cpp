@@ -0,0 +1,218 @@
+#include <topology.hpp>
+#include <atomic>
+#include <bit>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    // Triangles per parallel task
+    constexpr size_t chunkSize = 1u << 14u;
+    // Edge maps built independently, a power of two
+    constexpr size_t shardBits = 6u;
+    constexpr size_t shardCount = size_t(1) << shardBits;
+
+    // Vertex indices in the order the side is traversed
+    using EdgeKey = UnorderedPair<uint32_t>;
+
+    // One triangle side, the key keeps the direction it is traversed in
+    struct HalfEdge
+    {
+        EdgeKey key;
+        // Triangle index * 3 + the corner the side starts at
+        uint32_t corner;
+    };
+
+    // Triangles seen on one edge
+    struct EdgeUse
+    {
+        uint32_t count = 0u;
+        // Traversals from the lower to the higher index minus the opposite ones
+        int32_t balance = 0;
+        // Half edges of the first two triangles
+        uint32_t corners[2];
+    };
+
+    // Hash table entry, empty while its count is zero
+    struct EdgeSlot
+    {
+        uint64_t id;
+        EdgeUse use;
+    };
+
+    // Counts and corner pairs produced by one shard
+    struct ShardResult
+    {
+        TopologyReport report;
+        // Corners at the same vertex joined across an edge
+        std::vector<std::pair<uint32_t, uint32_t>> joins;
+    };
+
+    // Both indices packed side by side, equal ids mean equal edges regardless of direction
+    uint64_t edgeId(const EdgeKey& key)
+    {
+        return ((uint64_t)key.min() << 32) | key.max();
+    }
+
+    // Ids of neighbouring edges are close, mix before taking the top bits
+    size_t shardOf(const EdgeKey& key)
+    {
+        return (edgeId(key) * 0x9e3779b97f4a7c15ull) >> (64u - shardBits);
+    }
+
+    bool isDegenerate(const Vector3u& t, size_t vertexCount)
+    {
+        return t.x() == t.y() || t.y() == t.z() || t.z() == t.x() ||
+               t.maxCoeff() >= vertexCount;
+    }
+
+    uint32_t findRoot(std::vector<uint32_t>& parents, uint32_t c)
+    {
+        while (parents[c] != c) {
+            parents[c] = parents[parents[c]];
+            c = parents[c];
+        }
+        return c;
+    }
+}
+
+TopologyReport checkTopology(size_t vertexCount, const std::vector<Vector3u>& triangles)
+{
+    TopologyReport report;
+    const size_t chunkCount = (triangles.size() + chunkSize - 1u) / chunkSize;
+    std::vector<size_t> chunks(chunkCount);
+    std::iota(chunks.begin(), chunks.end(), 0u);
+    const auto chunkRange = [&](size_t chunk) {
+        const size_t begin = chunk * chunkSize;
+        return std::pair(begin, std::min(begin + chunkSize, triangles.size()));
+    };
+    const auto halfEdgeKey = [&](size_t t, int c) {
+        return EdgeKey(triangles[t][c], triangles[t][(c + 1) % 3]);
+    };
+
+    // Count half edges per chunk and shard, and mark referenced vertices
+    std::vector<uint8_t> referenced(vertexCount, 0u);
+    std::vector<uint8_t> degenerate(triangles.size(), 0u);
+    std::vector<size_t> counts(chunkCount * shardCount, 0u);
+    std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk) {
+        const auto [begin, end] = chunkRange(chunk);
+        size_t* chunkCounts = &counts[chunk * shardCount];
+        for (size_t t = begin; t < end; t++) {
+            if (isDegenerate(triangles[t], vertexCount)) {
+                degenerate[t] = 1u;
+                continue;
+            }
+            for (int c = 0; c < 3; c++) {
+                chunkCounts[shardOf(halfEdgeKey(t, c))]++;
+                std::atomic_ref<uint8_t>(referenced[triangles[t][c]])
+                    .store(1u, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    // Shard-major offsets, so every shard's half edges end up contiguous
+    std::vector<size_t> shardBegins(shardCount + 1u, 0u);
+    std::vector<size_t> offsets(counts.size());
+    size_t total = 0u;
+    for (size_t s = 0; s < shardCount; s++) {
+        shardBegins[s] = total;
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            offsets[chunk * shardCount + s] = total;
+            total += counts[chunk * shardCount + s];
+        }
+    }
+    shardBegins[shardCount] = total;
+
+    std::vector<HalfEdge> halfEdges(total);
+    std::for_each(std::execution::par, chunks.begin(), chunks.end(), [&](size_t chunk) {
+        const auto [begin, end] = chunkRange(chunk);
+        size_t* chunkOffsets = &offsets[chunk * shardCount];
+        for (size_t t = begin; t < end; t++) {
+            if (degenerate[t]) {
+                continue;
+            }
+            for (int c = 0; c < 3; c++) {
+                const EdgeKey key = halfEdgeKey(t, c);
+                halfEdges[chunkOffsets[shardOf(key)]++] = { key, uint32_t(t * 3u + c) };
+            }
+        }
+    });
+
+    // Count uses per edge, each shard in its own table
+    std::vector<ShardResult> shards(shardCount);
+    std::vector<size_t> shardIndices(shardCount);
+    std::iota(shardIndices.begin(), shardIndices.end(), 0u);
+    std::for_each(std::execution::par, shardIndices.begin(), shardIndices.end(), [&](size_t s) {
+        // Open addressing on the edge id. Every edge may be a boundary edge with a single half
+        // edge, twice as many slots keep the load factor at most one half.
+        const size_t halfEdgeCount = shardBegins[s + 1u] - shardBegins[s];
+        const size_t capacity = std::bit_ceil(2u * std::max(halfEdgeCount, size_t(1)));
+        std::vector<EdgeSlot> slots(capacity);
+        for (size_t h = shardBegins[s]; h < shardBegins[s + 1u]; h++) {
+            const HalfEdge& halfEdge = halfEdges[h];
+            const uint64_t id = edgeId(halfEdge.key);
+            size_t i = (id * 0x9e3779b97f4a7c15ull) & (capacity - 1u);
+            while (slots[i].use.count && slots[i].id != id) {
+                i = (i + 1u) & (capacity - 1u);
+            }
+            EdgeSlot& slot = slots[i];
+            slot.id = id;
+            if (slot.use.count < 2u) {
+                slot.use.corners[slot.use.count] = halfEdge.corner;
+            }
+            slot.use.count++;
+            slot.use.balance += halfEdge.key.first < halfEdge.key.second ? 1 : -1;
+        }
+
+        ShardResult& result = shards[s];
+        for (const EdgeSlot& slot : slots) {
+            const EdgeUse& use = slot.use;
+            if (use.count == 0u) {
+                continue;
+            }
+            if (use.count == 1u) {
+                result.report.boundaryEdges++;
+                continue;
+            }
+            if (use.count > 2u) {
+                result.report.nonManifoldEdges++;
+                continue;
+            }
+            if (use.balance != 0) {
+                result.report.misorientedEdges++;
+            }
+            // Join the corners of both triangles at each end of the edge
+            const uint32_t first = use.corners[0];
+            const Vector3u& triangle = triangles[first / 3u];
+            for (const uint32_t v : { triangle[first % 3u], triangle[(first + 1u) % 3u] }) {
+                const auto cornerAt = [&](uint32_t corner) {
+                    return triangles[corner / 3u][corner % 3u] == v
+                               ? corner
+                               : corner - corner % 3u + (corner + 1u) % 3u;
+                };
+                result.joins.emplace_back(cornerAt(use.corners[0]), cornerAt(use.corners[1]));
+            }
+        }
+    });
+
+    // Corners around a vertex that stay disconnected form separate fans
+    std::vector<uint32_t> parents(triangles.size() * 3u);
+    std::iota(parents.begin(), parents.end(), 0u);
+    for (const ShardResult& shard : shards) {
+        report.boundaryEdges += shard.report.boundaryEdges;
+        report.nonManifoldEdges += shard.report.nonManifoldEdges;
+        report.misorientedEdges += shard.report.misorientedEdges;
+        for (const auto& [a, b] : shard.joins) {
+            parents[findRoot(parents, a)] = findRoot(parents, b);
+        }
+    }
+    size_t fans = 0u;
+    for (size_t c = 0; c < parents.size(); c++) {
+        fans += !degenerate[c / 3u] && findRoot(parents, c) == c;
+    }
+    const size_t used = std::count(referenced.begin(), referenced.end(), 1u);
+    report.pinchedVertices = fans - used;
+    report.isolatedVertices = vertexCount - used;
+    report.degenerateTriangles = std::count(degenerate.begin(), degenerate.end(), 1u);
+    return report;
+}
@@ -162,6 +162,46 @@ Vector3f normal(const Vector3f& v0, const Vector3f& v1, const Vector3f& v2)
     return (v1 - v0).cross(v2 - v0).normalized();
 }
 
+Vector3f closestPoint(const Triangle& tri, const Vector3f& p)
+{
+    // Voronoi region classification from Ericson, Real-Time Collision Detection, 5.1.5
+    const auto& [a, b, c] = tri.verts;
+    const Vector3f ab = b - a;
+    const Vector3f ac = c - a;
+    const Vector3f ap = p - a;
+    const float d1 = ab.dot(ap);
+    const float d2 = ac.dot(ap);
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        return a;
+    }
+    const Vector3f bp = p - b;
+    const float d3 = ab.dot(bp);
+    const float d4 = ac.dot(bp);
+    if (d3 >= 0.0f && d4 <= d3) {
+        return b;
+    }
+    const float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        return a + ab * (d1 / (d1 - d3));
+    }
+    const Vector3f cp = p - c;
+    const float d5 = ab.dot(cp);
+    const float d6 = ac.dot(cp);
+    if (d6 >= 0.0f && d5 <= d6) {
+        return c;
+    }
+    const float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        return a + ac * (d2 / (d2 - d6));
+    }
+    const float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+    const float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+}
+
 Vector3f clamp(const Vector3f& v, const Vector3f& vmin, const Vector3f& max)
 {
     return v.cwiseMax(vmin).cwiseMin(max);
@@ -0,0 +1,168 @@
+#include <winding.hpp>
+#include <execution>
+#include <numeric>
+
+namespace
+{
+    constexpr float fourPi = 2.0f * tau;
+    // Traversal stack entries reserved up front, enough for balanced trees of any practical size
+    constexpr size_t stackReserve = 64u;
+
+    // Signed solid angle of a triangle seen from a point, van Oosterom and Strackee
+    float solidAngle(const std::array<Vector3f, 3>& corners, const Vector3f& point)
+    {
+        const Vector3f a = corners[0] - point;
+        const Vector3f b = corners[1] - point;
+        const Vector3f c = corners[2] - point;
+        const float la = a.norm(), lb = b.norm(), lc = c.norm();
+        const float numerator = a.dot(b.cross(c));
+        const float denominator = la * lb * lc + a.dot(b) * lc + b.dot(c) * la + c.dot(a) * lb;
+        return 2.0f * std::atan2(numerator, denominator);
+    }
+}
+
+WindingTree::WindingTree(
+    const std::vector<Vector3f>& vertices,
+    const std::vector<Vector3u>& triangles
+)
+{
+    const uint32_t n = (uint32_t)triangles.size();
+    if (n == 0u) {
+        return;
+    }
+    std::vector<uint32_t> order(n);
+    std::iota(order.begin(), order.end(), 0u);
+    std::vector<Vector3f> centroids(n);
+    std::for_each(std::execution::par, order.begin(), order.end(), [&](uint32_t t) {
+        centroids[t] =
+            (vertices[triangles[t].x()] + vertices[triangles[t].y()] + vertices[triangles[t].z()]) /
+            3.0f;
+    });
+
+    // Median splits along the widest axis, children are appended after their parent
+    this->nodes.reserve(2u * n / leafSize + 1u);
+    this->nodes.push_back({ Vector3f::Zero(), 0.0f, Vector3f::Zero(), 0u, n });
+    std::vector<uint32_t> stack{ 0u };
+    while (!stack.empty()) {
+        const uint32_t index = stack.back();
+        stack.pop_back();
+        const uint32_t begin = this->nodes[index].first;
+        const uint32_t count = this->nodes[index].count;
+        if (count <= leafSize) {
+            continue;
+        }
+        Vector3f lo = Vector3f::Constant(std::numeric_limits<float>::max());
+        Vector3f hi = Vector3f::Constant(std::numeric_limits<float>::lowest());
+        for (uint32_t i = begin; i < begin + count; i++) {
+            lo = lo.cwiseMin(centroids[order[i]]);
+            hi = hi.cwiseMax(centroids[order[i]]);
+        }
+        int axis;
+        (hi - lo).maxCoeff(&axis);
+        const uint32_t mid = begin + count / 2u;
+        std::nth_element(
+            order.begin() + begin, order.begin() + mid, order.begin() + begin + count,
+            [&](uint32_t a, uint32_t b) { return centroids[a][axis] < centroids[b][axis]; }
+        );
+        const uint32_t child = (uint32_t)this->nodes.size();
+        this->nodes[index].first = child;
+        this->nodes[index].count = 0u;
+        this->nodes.push_back({ Vector3f::Zero(), 0.0f, Vector3f::Zero(), begin, mid - begin });
+        this->nodes.push_back(
+            { Vector3f::Zero(), 0.0f, Vector3f::Zero(), mid, begin + count - mid }
+        );
+        stack.push_back(child);
+        stack.push_back(child + 1u);
+    }
+
+    this->corners.resize(n);
+    std::vector<float> areas(n);
+    std::vector<Vector3f> normals(n);
+    double signedVolume = 0.0;
+    for (uint32_t s = 0; s < n; s++) {
+        const Vector3u& t = triangles[order[s]];
+        this->corners[s] = { vertices[t.x()], vertices[t.y()], vertices[t.z()] };
+        const auto& [a, b, c] = this->corners[s];
+        normals[s] = (b - a).cross(c - a) / 2.0f;
+        areas[s] = normals[s].norm();
+        signedVolume += a.dot(b.cross(c));
+    }
+    this->orientation = signedVolume < 0.0 ? -1.0f : 1.0f;
+
+    // Moments bottom-up, walking the nodes backwards visits children before parents
+    std::vector<float> nodeAreas(this->nodes.size());
+    for (size_t i = this->nodes.size(); i-- > 0u;) {
+        Node& node = this->nodes[i];
+        Vector3f weighted = Vector3f::Zero();
+        if (node.count == 0u) {
+            const Node* children[2] = { &this->nodes[node.first], &this->nodes[node.first + 1u] };
+            for (int c = 0; c < 2; c++) {
+                node.dipole += children[c]->dipole;
+                nodeAreas[i] += nodeAreas[node.first + c];
+                weighted += nodeAreas[node.first + c] * children[c]->center;
+            }
+            node.center = nodeAreas[i] > 0.0f ? Vector3f(weighted / nodeAreas[i])
+                                              : (children[0]->center + children[1]->center) / 2.0f;
+            for (int c = 0; c < 2; c++) {
+                node.radius = std::max(
+                    node.radius, (children[c]->center - node.center).norm() + children[c]->radius
+                );
+            }
+        } else {
+            Vector3f mean = Vector3f::Zero();
+            for (uint32_t s = node.first; s < node.first + node.count; s++) {
+                const auto& [a, b, c] = this->corners[s];
+                node.dipole += normals[s];
+                nodeAreas[i] += areas[s];
+                weighted += areas[s] * (a + b + c) / 3.0f;
+                mean += (a + b + c) / 3.0f;
+            }
+            node.center = nodeAreas[i] > 0.0f ? Vector3f(weighted / nodeAreas[i])
+                                              : Vector3f(mean / (float)node.count);
+            for (uint32_t s = node.first; s < node.first + node.count; s++) {
+                for (const Vector3f& corner : this->corners[s]) {
+                    node.radius = std::max(node.radius, (corner - node.center).norm());
+                }
+            }
+        }
+    }
+}
+
+float WindingTree::winding(const Vector3f& point) const
+{
+    if (this->empty()) {
+        return 0.0f;
+    }
+    float sum = 0.0f;
+    std::vector<uint32_t> stack;
+    stack.reserve(stackReserve);
+    stack.push_back(0u);
+    while (!stack.empty()) {
+        const Node& node = this->nodes[stack.back()];
+        stack.pop_back();
+        const Vector3f offset = node.center - point;
+        const float distance = offset.norm();
+        if (distance > this->beta * node.radius) {
+            // Dipole term, the far field of the node's triangles
+            sum += offset.dot(node.dipole) / (distance * distance * distance);
+        } else if (node.count == 0u) {
+            stack.push_back(node.first);
+            stack.push_back(node.first + 1u);
+        } else {
+            for (uint32_t s = node.first; s < node.first + node.count; s++) {
+                sum += solidAngle(this->corners[s], point);
+            }
+        }
+    }
+    return this->orientation * sum / fourPi;
+}
+
+std::vector<float> WindingTree::winding(const std::vector<Vector3f>& points) const
+{
+    std::vector<float> result(points.size());
+    std::transform(
+        std::execution::par, points.begin(), points.end(), result.begin(),
+        [&](const Vector3f& point) { return this->winding(point); }
+    );
+    return result;
+}